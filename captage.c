@@ -0,0 +1,307 @@
+#include "tipe.h"
+
+/*
+ * Placement par captage de flux (modèle de localisation des stations de
+ * recharge sur les chemins, « flow-refueling ») : contrairement au k-médian,
+ * qui rapproche chaque sommet d'une station, on cherche les k stations qui
+ * rendent faisables le plus de trajets le long de leur plus court chemin.
+ *
+ * Un trajet o → d de longueur L part batterie pleine. En notant p_j la
+ * position du j-ème sommet du chemin, il est faisable ssi chaque fenêtre
+ * F_i = { sommets j : p_i < p_j <= p_i + AUTONOMIE } avec p_i < L - AUTONOMIE
+ * contient une station. Chaque fenêtre est un ensemble de bits sur les
+ * sommets candidats ; une fenêtre incluse dans une autre est inutile, seules
+ * les fenêtres minimales sont gardées.
+ *
+ * La demande suit generer_trafic() : pop[o] / (n - 1) pour chaque
+ * destination. Seuls les trajets plus longs que l'autonomie comptent (les
+ * autres sont toujours faisables) ; au-delà de MAX_FLUX_CAPTAGE, on garde
+ * les origines les plus peuplées.
+ */
+
+typedef struct {
+    int n, W; // Candidats (tous les sommets) et mots par fenêtre
+    int nb; // Nombre de chemins
+    double *flux;
+    int *debut; // Fenêtres du chemin c : fenetres[debut[c] .. debut[c+1]-1]
+    Mot *fenetres;
+    double flux_total; // Flux de tous les trajets longs considérés
+    double flux_impossible; // Dont trajets infaisables quelles que soient les stations
+} Chemins;
+
+typedef struct {
+    double gain; // Flux des chemins complétés par le candidat seul
+    double partiel; // Part des fenêtres restantes couvertes, pondérée par le flux (départage)
+} Gain;
+
+// ---- ÉNUMÉRATION DES CHEMINS ----
+
+void chemins_ajouter_fenetre(Chemins *ch, int *nb_fenetres, int *capacite, int *sommets, int a, int b) {
+    if (*nb_fenetres == *capacite) {
+        *capacite *= 2;
+        ch->fenetres = realloc(ch->fenetres, (size_t)*capacite * ch->W * sizeof(Mot));
+        if (ch->fenetres == NULL) {
+            fprintf(stderr, "Erreur : impossible d'allouer les fenêtres des chemins.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    Mot *f = &ch->fenetres[(size_t)*nb_fenetres * ch->W];
+    memset(f, 0, ch->W * sizeof(Mot));
+    for (int j = a; j <= b; j++) bit_mettre(f, sommets[j]);
+    (*nb_fenetres)++;
+}
+
+int comparer_origines(const void *x, const void *y) {
+    const ElementTas *a = x, *b = y;
+    if (a->cle != b->cle) return (a->cle < b->cle) - (a->cle > b->cle); // Population décroissante
+    return a->val - b->val;
+}
+
+Chemins chemins_calculer(Graph *g) {
+    Csr c = csr_from_graph(g);
+    int n = c.n;
+    Chemins ch = { n, MOTS(n > 0 ? n : 1), 0, NULL, NULL, NULL, 0.0, 0.0 };
+    int capacite_chemins = 64, capacite_fenetres = 256, nb_fenetres = 0;
+    ch.flux = malloc(capacite_chemins * sizeof(double));
+    ch.debut = malloc((capacite_chemins + 1) * sizeof(int));
+    ch.fenetres = malloc((size_t)capacite_fenetres * ch.W * sizeof(Mot));
+    ch.debut[0] = 0;
+
+    ElementTas *origines = malloc((n > 0 ? n : 1) * sizeof(ElementTas));
+    for (int v = 0; v < n; v++) {
+        origines[v].cle = get_vertix_attribute(g, v, ATTR_POP);
+        origines[v].val = v;
+    }
+    qsort(origines, n, sizeof(ElementTas), comparer_origines);
+
+    double *dist = malloc((n > 0 ? n : 1) * sizeof(double));
+    int *pred = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *sommets = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *fin = malloc((n > 0 ? n : 1) * sizeof(int));
+    for (int r = 0; r < n && ch.nb < MAX_FLUX_CAPTAGE; r++) {
+        int o = origines[r].val;
+        double flux = n > 1 ? origines[r].cle / (n - 1) : 0.0;
+        if (flux <= 0.0) continue;
+        dijkstra(&c, &o, 1, dist, pred);
+
+        for (int d = 0; d < n; d++) {
+            double L = dist[d];
+            if (d == o || isinf(L) || L <= AUTONOMIE) continue;
+
+            /* Sommets du chemin depuis l'origine (positions : dist) */
+            int h = 0;
+            for (int v = d; v != -1; v = pred[v]) sommets[h++] = v;
+            for (int i = 0; i < h / 2; i++) {
+                int tmp = sommets[i];
+                sommets[i] = sommets[h - 1 - i];
+                sommets[h - 1 - i] = tmp;
+            }
+
+            if (ch.nb == capacite_chemins) {
+                capacite_chemins *= 2;
+                ch.flux = realloc(ch.flux, capacite_chemins * sizeof(double));
+                ch.debut = realloc(ch.debut, (capacite_chemins + 1) * sizeof(int));
+            }
+            ch.flux_total += flux;
+
+            /* Fenêtres [i+1, fin[i]] ; F_i est inutile si fin[i+1] = fin[i] */
+            bool possible = true;
+            int debut_chemin = nb_fenetres;
+            int nb = 0;
+            for (int i = 0, b = 0; i < h && dist[sommets[i]] < L - AUTONOMIE; i++, nb++) {
+                while (b + 1 < h && dist[sommets[b+1]] <= dist[sommets[i]] + AUTONOMIE) b++;
+                fin[i] = b;
+                if (b < i + 1) possible = false; // Arête plus longue que l'autonomie
+            }
+            for (int i = 0; i < nb && possible; i++) {
+                if (i + 1 == nb || fin[i+1] > fin[i]) chemins_ajouter_fenetre(&ch, &nb_fenetres, &capacite_fenetres, sommets, i + 1, fin[i]);
+            }
+            if (!possible) {
+                nb_fenetres = debut_chemin;
+                ch.flux_impossible += flux;
+                continue;
+            }
+            ch.flux[ch.nb] = flux;
+            ch.debut[++ch.nb] = nb_fenetres;
+        }
+    }
+
+    free(dist);
+    free(pred);
+    free(sommets);
+    free(fin);
+    free(origines);
+    free_csr(&c);
+    return ch;
+}
+
+void free_chemins(Chemins *ch) {
+    free(ch->flux);
+    free(ch->debut);
+    free(ch->fenetres);
+}
+
+// ---- ÉVALUATION ----
+
+bool chemin_capte(Chemins *ch, int c, const Mot *S) {
+    for (int f = ch->debut[c]; f < ch->debut[c+1]; f++) {
+        if (!bits_intersectent(&ch->fenetres[(size_t)f * ch->W], S, ch->W)) return false;
+    }
+    return true;
+}
+
+double flux_captes(Chemins *ch, const Mot *S) {
+    double total = 0.0;
+    for (int c = 0; c < ch->nb; c++) {
+        if (chemin_capte(ch, c, S)) total += ch->flux[c];
+    }
+    return total;
+}
+
+/* Pour chaque candidat, flux des chemins non captés par S que ce candidat
+ * suffit à compléter : intersection des fenêtres non couvertes de chaque
+ * chemin. Renvoie le flux capté par S. */
+double calculer_gains(Chemins *ch, const Mot *S, Gain *gains, Mot *inter) {
+    int W = ch->W;
+    double capte = 0.0;
+    memset(gains, 0, ch->n * sizeof(Gain));
+    for (int c = 0; c < ch->nb; c++) {
+        int restantes = 0, total = ch->debut[c+1] - ch->debut[c];
+        for (int w = 0; w < W; w++) inter[w] = ~(Mot)0;
+        for (int f = ch->debut[c]; f < ch->debut[c+1]; f++) {
+            const Mot *fenetre = &ch->fenetres[(size_t)f * W];
+            if (bits_intersectent(fenetre, S, W)) continue;
+            restantes++;
+            for (int w = 0; w < W; w++) inter[w] &= fenetre[w];
+        }
+        if (restantes == 0) {
+            capte += ch->flux[c];
+            continue;
+        }
+
+        double part = ch->flux[c] / total;
+        for (int f = ch->debut[c]; f < ch->debut[c+1]; f++) {
+            const Mot *fenetre = &ch->fenetres[(size_t)f * W];
+            if (bits_intersectent(fenetre, S, W)) continue;
+            for (int w = 0; w < W; w++) {
+                for (Mot mot = fenetre[w]; mot; mot &= mot - 1) {
+                    gains[w * 64 + __builtin_ctzll(mot)].partiel += part;
+                }
+            }
+        }
+        for (int w = 0; w < W; w++) {
+            for (Mot mot = inter[w]; mot; mot &= mot - 1) {
+                int v = w * 64 + __builtin_ctzll(mot);
+                if (v < ch->n) gains[v].gain += ch->flux[c];
+            }
+        }
+    }
+    return capte;
+}
+
+/* Meilleur candidat hors de S (gain, puis gain partiel) ; -1 si aucun. */
+int meilleur_candidat(Chemins *ch, const Mot *S, Gain *gains) {
+    int meilleur = -1;
+    for (int v = 0; v < ch->n; v++) {
+        if (bit_tester(S, v)) continue;
+        if (meilleur == -1 || gains[v].gain > gains[meilleur].gain
+            || (gains[v].gain == gains[meilleur].gain && gains[v].partiel > gains[meilleur].partiel)) {
+            meilleur = v;
+        }
+    }
+    return meilleur;
+}
+
+// ---- RÉSOLUTION ----
+
+/* Glouton : ajoute à chaque étape le sommet qui complète le plus de flux. */
+double captage_glouton(Chemins *ch, int k, int *stations, Mot *S) {
+    Gain *gains = malloc(ch->n * sizeof(Gain));
+    Mot *inter = malloc(ch->W * sizeof(Mot));
+    memset(S, 0, ch->W * sizeof(Mot));
+    for (int i = 0; i < k; i++) {
+        calculer_gains(ch, S, gains, inter);
+        stations[i] = meilleur_candidat(ch, S, gains);
+        bit_mettre(S, stations[i]);
+    }
+    free(gains);
+    free(inter);
+    return flux_captes(ch, S);
+}
+
+/* Échanges : pour chaque station s, les gains de tous les candidats sont
+ * calculés en une passe sur S \ {s} ; le meilleur remplace s s'il capte
+ * strictement plus de flux. */
+double captage_echanges(Chemins *ch, int k, int *stations, Mot *S, double capte) {
+    Gain *gains = malloc(ch->n * sizeof(Gain));
+    Mot *inter = malloc(ch->W * sizeof(Mot));
+    bool continuer = true;
+    while (continuer) {
+        continuer = false;
+        for (int i = 0; i < k; i++) {
+            int s = stations[i];
+            S[s / 64] &= ~((Mot)1 << (s % 64));
+            double base = calculer_gains(ch, S, gains, inter);
+            bit_mettre(S, s); // s n'est pas un candidat pour lui-même
+            int v = meilleur_candidat(ch, S, gains);
+            S[s / 64] &= ~((Mot)1 << (s % 64));
+            if (v >= 0 && base + gains[v].gain > capte + 1e-9 * (1.0 + capte)) {
+                stations[i] = v;
+                capte = base + gains[v].gain;
+                continuer = true;
+            }
+            bit_mettre(S, stations[i]);
+        }
+    }
+    free(gains);
+    free(inter);
+    return capte;
+}
+
+/**
+ * Place k stations maximisant le flux de trajets longs rendus faisables
+ * (glouton puis échanges) et les marque comme CHARGEUR. Renvoie la part du
+ * flux captée (en %).
+ */
+double captage_placement(Graph *g, int k, int *stations) {
+    int n = vertices_count(g);
+    if (k > n) k = n;
+    printf("\nCAPTAGE DE FLUX (k=%d)\n\n", k);
+    clock_t debut = clock();
+    Chemins ch = chemins_calculer(g);
+    size_t nb_fenetres = ch.debut[ch.nb];
+    printf("%d trajets longs, %zu fenêtres (%.1f Mo), %.2f %% du flux infaisable quelles que soient les stations (%.2f s)\n",
+           ch.nb, nb_fenetres, nb_fenetres * ch.W * sizeof(Mot) / (1024.0 * 1024.0),
+           ch.flux_total > 0.0 ? 100.0 * ch.flux_impossible / ch.flux_total : 0.0,
+           (double)(clock() - debut) / CLOCKS_PER_SEC);
+
+    Mot *S = calloc(ch.W, sizeof(Mot));
+    debut = clock();
+    double capte = captage_glouton(&ch, k, stations, S);
+    printf("Flux capté après glouton : %.2f %% (%.2f s)\n",
+           ch.flux_total > 0.0 ? 100.0 * capte / ch.flux_total : 0.0, (double)(clock() - debut) / CLOCKS_PER_SEC);
+    debut = clock();
+    capte = captage_echanges(&ch, k, stations, S, capte);
+    double part = ch.flux_total > 0.0 ? 100.0 * capte / ch.flux_total : 0.0;
+    printf("Flux capté après échanges : %.2f %% (%.2f s)\n", part, (double)(clock() - debut) / CLOCKS_PER_SEC);
+
+    for (int i = 0; i < k; i++) {
+        printf("Station %d : %d\n", i, stations[i]);
+        set_vertix_attribute(g, stations[i], ATTR_STATION, CHARGEUR);
+    }
+
+    free(S);
+    free_chemins(&ch);
+    return part;
+}
+
+/* Part du flux des trajets longs captée par un placement existant (en %). */
+double captage_evaluer(Graph *g, int *stations, int nb) {
+    Chemins ch = chemins_calculer(g);
+    Mot *S = calloc(ch.W, sizeof(Mot));
+    for (int i = 0; i < nb; i++) bit_mettre(S, stations[i]);
+    double part = ch.flux_total > 0.0 ? 100.0 * flux_captes(&ch, S) / ch.flux_total : 0.0;
+    free(S);
+    free_chemins(&ch);
+    return part;
+}
@@ -12,7 +12,7 @@ typedef struct {
     int row_count;
 } CSVFile;
 
-CSVRow read_csv_row(FILE *file) {
+CSVRow read_csv_row(FILE *file, const char *separateurs) {
     char line[MAX_LINE_LENGTH];
     CSVRow row;
     row.fields = malloc(MAX_FIELDS * sizeof(char *));
@@ -24,18 +24,21 @@ CSVRow read_csv_row(FILE *file) {
             row.field_count = 0;
             return row;
         }
-        char *token = strtok(line, ",\n");
+        char *token = strtok(line, separateurs);
         while (token != NULL) {
             row.fields[row.field_count] = strdup(token);
             row.field_count++;
-            token = strtok(NULL, ",\n");
+            token = strtok(NULL, separateurs);
         }
     }
+    if (row.field_count == 0) {
+        free(row.fields);
+    }
 
     return row;
 }
 
-CSVFile read_csv(const char *filename) {
+CSVFile read_csv(const char *filename, const char *separateurs) {
     FILE *file = fopen(filename, "r");
     if (file == NULL) {
         perror("Erreur d'ouverture du fichier CSV");
@@ -43,12 +46,21 @@ CSVFile read_csv(const char *filename) {
     }
 
     CSVFile csv;
-    csv.rows = malloc(MAX_LINE_LENGTH * sizeof(CSVRow));
+    int capacite = MAX_LINE_LENGTH;
+    csv.rows = malloc(capacite * sizeof(CSVRow));
     csv.row_count = 0;
 
     while (!feof(file)) {
-        CSVRow row = read_csv_row(file);
+        CSVRow row = read_csv_row(file, separateurs);
         if (row.field_count > 0) {
+            if (csv.row_count == capacite) {
+                capacite *= 2;
+                csv.rows = realloc(csv.rows, capacite * sizeof(CSVRow));
+                if (csv.rows == NULL) {
+                    fprintf(stderr, "Erreur : impossible d'agrandir le fichier CSV %s.\n", filename);
+                    exit(EXIT_FAILURE);
+                }
+            }
             csv.rows[csv.row_count] = row;
             csv.row_count++;
         }
@@ -107,7 +119,7 @@ Graph graph_from_csv(char *vertices_file, char *edges_file) {
     }
 
     /* Lecture du CSV des sommets ------------------------------------ */
-    CSVFile vcsv = read_csv(vertices_file);
+    CSVFile vcsv = read_csv(vertices_file, ",\n");
     int nb_lignes = vcsv.row_count;
 
     Graph g = init(nb_lignes);
@@ -134,7 +146,7 @@ Graph graph_from_csv(char *vertices_file, char *edges_file) {
     }
 
     /* Lecture du CSV des arêtes ------------------------------------- */
-    CSVFile ecsv = read_csv(edges_file);
+    CSVFile ecsv = read_csv(edges_file, ",\n");
 
     /*Vector edges_vec, w_vec;
     init_vector(&edges_vec, ecsv.row_count * ecsv.row_count);
@@ -188,3 +200,110 @@ Graph graph_from_csv(char *vertices_file, char *edges_file) {
 
     return g;
 }
+
+/* ------------------------------------------------------------------ *
+ *  Charge des stations existantes depuis un CSV "nom ; long ; lat"
+ *  (le nom peut contenir des virgules) et rattache chacune au sommet
+ *  le plus proche du graphe. Les doublons sont fusionnés.
+ * ------------------------------------------------------------------ */
+Placement placement_from_csv(Graph *g, char *stations_file, char *nom) {
+    CSVFile csv = read_csv(stations_file, ";\n");
+    Placement p = placement_init(nom, csv.row_count);
+    bool *deja = calloc(vertices_count(g), sizeof(bool));
+
+    for (int r = 0; r < csv.row_count; r++) {
+        CSVRow row = csv.rows[r];
+        if (row.field_count < 3) continue;
+
+        double lon = atof(row.fields[1]);
+        double lat = atof(row.fields[2]);
+        int best = -1;
+        double best_dist = +DBL_MAX;
+        for (int i = 0; i < vertices_count(g); i++) {
+            double d = haversine(lon, lat, get_vertix_attribute(g, i, ATTR_LONG), get_vertix_attribute(g, i, ATTR_LAT));
+            if (d < best_dist) {
+                best_dist = d;
+                best = i;
+            }
+        }
+        if (best != -1 && !deja[best]) {
+            deja[best] = true;
+            p.sommets[p.nb++] = best;
+        }
+    }
+
+    free(deja);
+    free_csv_file(csv);
+    return p;
+}
+
+/* ------------------------------------------------------------------ *
+ *  Construit le graphe des k plus proches voisins à partir du CSV des
+ *  sommets (long, lat, population). Si routes_file n'est pas NULL,
+ *  ses distances (long1, lat1, long2, lat2, distance) remplacent
+ *  l'estimation à vol d'oiseau pour les arêtes concernées.
+ * ------------------------------------------------------------------ */
+Graph graph_knn_from_csv(char *vertices_file, int k, double facteur_detour, char *routes_file) {
+    CSVFile vcsv = read_csv(vertices_file, ",\n");
+    int n = 0;
+    double *lon = malloc(vcsv.row_count * sizeof(double));
+    double *lat = malloc(vcsv.row_count * sizeof(double));
+    double *pop = malloc(vcsv.row_count * sizeof(double));
+    for (int i = 0; i < vcsv.row_count; i++) {
+        CSVRow row = vcsv.rows[i];
+        if (row.field_count < 3) continue;
+        lon[n] = atof(row.fields[0]);
+        lat[n] = atof(row.fields[1]);
+        pop[n] = atof(row.fields[2]);
+        n++;
+    }
+
+    Troncon *troncons = NULL;
+    int nb_troncons = 0;
+    if (routes_file != NULL) {
+        CSVFile rcsv = read_csv(routes_file, ",\n");
+        troncons = malloc(rcsv.row_count * sizeof(Troncon));
+        for (int r = 0; r < rcsv.row_count; r++) {
+            CSVRow row = rcsv.rows[r];
+            if (row.field_count < 5) continue;
+            troncons[nb_troncons].lon1 = atof(row.fields[0]);
+            troncons[nb_troncons].lat1 = atof(row.fields[1]);
+            troncons[nb_troncons].lon2 = atof(row.fields[2]);
+            troncons[nb_troncons].lat2 = atof(row.fields[3]);
+            troncons[nb_troncons].distance = atof(row.fields[4]);
+            nb_troncons++;
+        }
+        free_csv_file(rcsv);
+    }
+
+    Graph g = graph_knn(n, lon, lat, pop, k, facteur_detour, troncons, nb_troncons);
+
+    free(troncons);
+    free(lon);
+    free(lat);
+    free(pop);
+    free_csv_file(vcsv);
+    return g;
+}
+
+/* Écrit les arêtes au format lu par graph_from_csv(). Les coordonnées sont
+ * écrites avec assez de chiffres pour être relues à l'identique. */
+void graph_edges_to_csv(Graph *g, char *edges_file) {
+    FILE *file = fopen(edges_file, "w");
+    if (file == NULL) {
+        perror("Erreur d'ouverture du fichier CSV");
+        return;
+    }
+
+    fprintf(file, "# long1, lat1, long2, lat2, distance\n");
+    for (int e = 0; e < edges_count(g); e++) {
+        int a, b;
+        get_edge_vertices(g, e, &a, &b);
+        fprintf(file, "%.17g,%.17g,%.17g,%.17g,%.2f\n",
+                get_vertix_attribute(g, a, ATTR_LONG), get_vertix_attribute(g, a, ATTR_LAT),
+                get_vertix_attribute(g, b, ATTR_LONG), get_vertix_attribute(g, b, ATTR_LAT),
+                get_edge_attribute(g, e, ATTR_WEIGHT));
+    }
+
+    fclose(file);
+}
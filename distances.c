@@ -0,0 +1,528 @@
+#include "tipe.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define EPSILON_DISTANCE 1e-9
+#define MAGIQUE_CACHE "TIPEDIST"
+#define VERSION_CACHE 1
+
+// ---- DIJKSTRA ----
+
+/**
+ * Dijkstra multi-sources sur un graphe CSR : dist[v] reçoit la distance de v
+ * à la source la plus proche (INFINITY si inaccessible). pred peut être NULL ;
+ * sinon pred[v] est le prédécesseur de v sur le plus court chemin (-1 pour
+ * les sources et les sommets inaccessibles). Les arêtes de poids infini sont
+ * considérées comme coupées.
+ */
+void dijkstra(Csr *c, int *sources, int nb_sources, double *dist, int *pred) {
+    for (int v = 0; v < c->n; v++) {
+        dist[v] = INFINITY;
+        if (pred != NULL) pred[v] = -1;
+    }
+
+    Tas tas = tas_init(c->n);
+    for (int i = 0; i < nb_sources; i++) {
+        dist[sources[i]] = 0.0;
+        tas_inserer(&tas, 0.0, sources[i]);
+    }
+
+    while (!tas_vide(&tas)) {
+        ElementTas min = tas_extraire(&tas);
+        int u = min.val;
+        if (min.cle > dist[u]) continue; // Entrée obsolète
+        for (int e = c->debut[u]; e < c->debut[u+1]; e++) {
+            int v = c->voisins[e];
+            double d = min.cle + c->poids[e];
+            if (d < dist[v]) {
+                dist[v] = d;
+                if (pred != NULL) pred[v] = u;
+                tas_inserer(&tas, d, v);
+            }
+        }
+    }
+
+    free_tas(&tas);
+}
+
+// ---- MATRICE DES DISTANCES ----
+
+Distances distances_init(int n) {
+    Distances D = { n, NULL, DIST_DOUBLE, NULL, 0.0, NULL, 0 };
+    D.d = malloc((size_t)n * n * sizeof(double));
+    if (D.d == NULL) {
+        fprintf(stderr, "Erreur : impossible d'allouer la matrice des distances (%d sommets).\n", n);
+        exit(EXIT_FAILURE);
+    }
+    return D;
+}
+
+Distances distances_calculer(Graph *g) {
+    Distances D = distances_init(vertices_count(g));
+    Csr c = csr_from_graph(g);
+    for (int s = 0; s < D.n; s++) {
+        dijkstra(&c, &s, 1, &D.d[(size_t)s * D.n], NULL);
+    }
+    free_csr(&c);
+
+    return D;
+}
+
+void free_distances(Distances *D) {
+    if (D->carte != NULL) {
+        munmap(D->carte, D->taille_carte);
+    } else {
+        free((void *)D->q);
+    }
+    free(D->d);
+    D->d = NULL;
+    D->q = NULL;
+    D->carte = NULL;
+    D->n = 0;
+}
+
+// ---- CACHE SUR DISQUE ----
+
+/*
+ * Les distances d'un graphe sont enregistrées une fois pour toutes dans un
+ * fichier nommé d'après l'empreinte du graphe (FNV-1a de la topologie et des
+ * poids) et le format, puis projetées en mémoire (mmap) aux exécutions suivantes : aucun
+ * Dijkstra tant que le réseau ne change pas. Les valeurs sont quantifiées
+ * (float, ou entiers 16/32 bits à pas fixe) et rangées par tuiles de
+ * TUILE_DISTANCES × TUILE_DISTANCES pour que les lectures par colonne de
+ * cost() restent locales. Erreur d'arrondi : echelle / 2 par distance.
+ */
+
+typedef struct { // En-tête du fichier cache (64 octets)
+    char magique[8];
+    uint32_t version;
+    uint32_t format;
+    uint64_t empreinte;
+    int32_t n;
+    int32_t tuile;
+    double echelle;
+    char reserve[24];
+} EnteteCache;
+
+uint64_t fnv1a(uint64_t h, const void *donnees, size_t taille) {
+    const unsigned char *octets = donnees;
+    for (size_t i = 0; i < taille; i++) {
+        h ^= octets[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint64_t empreinte_graphe(Graph *g) {
+    int32_t n = vertices_count(g), m = edges_count(g);
+    uint64_t h = 14695981039346656037ULL;
+    h = fnv1a(h, &n, sizeof(n));
+    h = fnv1a(h, &m, sizeof(m));
+
+    igraph_vector_int_t aretes;
+    igraph_vector_int_init(&aretes, 0);
+    igraph_get_edgelist(g, &aretes, false);
+    Vector poids;
+    init_vector(&poids, m);
+    igraph_es_t es;
+    igraph_es_all(&es, IGRAPH_EDGEORDER_ID);
+    igraph_cattribute_EANV(g, ATTR_WEIGHT, es, &poids);
+    for (int e = 0; e < m; e++) {
+        int32_t extremites[2] = { (int32_t)VECTOR(aretes)[2*e], (int32_t)VECTOR(aretes)[2*e+1] };
+        double w = VECTOR(poids)[e];
+        h = fnv1a(h, extremites, sizeof(extremites));
+        h = fnv1a(h, &w, sizeof(w));
+    }
+
+    igraph_vector_int_destroy(&aretes);
+    igraph_vector_destroy(&poids);
+    igraph_es_destroy(&es);
+    return h;
+}
+
+size_t taille_valeur(FormatDistances format) {
+    switch (format) {
+    case DIST_U16: return sizeof(uint16_t);
+    case DIST_FLOAT: return sizeof(float);
+    case DIST_U32: return sizeof(uint32_t);
+    default: return sizeof(double);
+    }
+}
+
+size_t taille_quantifiee(int n, FormatDistances format) {
+    size_t tuiles = (n + TUILE_DISTANCES - 1) / TUILE_DISTANCES;
+    return tuiles * tuiles * TUILE_DISTANCES * TUILE_DISTANCES * taille_valeur(format);
+}
+
+/* Majorant de toutes les distances finies : deux fois la plus grande
+ * excentricité d'un sommet de chaque composante connexe. */
+double borne_distances(Csr *c) {
+    int *racines = malloc((c->n > 0 ? c->n : 1) * sizeof(int));
+    int *file = malloc((c->n > 0 ? c->n : 1) * sizeof(int));
+    bool *vu = calloc(c->n > 0 ? c->n : 1, sizeof(bool));
+    int nb_racines = 0;
+    for (int r = 0; r < c->n; r++) {
+        if (vu[r]) continue;
+        racines[nb_racines++] = r;
+        int tete = 0, queue = 0;
+        vu[r] = true;
+        file[queue++] = r;
+        while (tete < queue) {
+            int u = file[tete++];
+            for (int e = c->debut[u]; e < c->debut[u+1]; e++) {
+                if (!vu[c->voisins[e]] && !isinf(c->poids[e])) {
+                    vu[c->voisins[e]] = true;
+                    file[queue++] = c->voisins[e];
+                }
+            }
+        }
+    }
+
+    double *dist = malloc((c->n > 0 ? c->n : 1) * sizeof(double));
+    dijkstra(c, racines, nb_racines, dist, NULL);
+    double borne = 0.0;
+    for (int v = 0; v < c->n; v++) {
+        if (!isinf(dist[v]) && 2 * dist[v] > borne) borne = 2 * dist[v];
+    }
+
+    free(dist);
+    free(racines);
+    free(file);
+    free(vu);
+    return borne;
+}
+
+/* Calcule toutes les distances source par source directement dans le
+ * format quantifié, sans passer par la matrice de double. */
+Distances distances_quantifier(Graph *g, FormatDistances format) {
+    Csr c = csr_from_graph(g);
+    Distances D = { c.n, NULL, format, NULL, 0.0, NULL, 0 };
+    if (format == DIST_U16) D.echelle = fmax(0.001, borne_distances(&c) / (UINT16_MAX - 1));
+    if (format == DIST_U32) D.echelle = fmax(0.001, borne_distances(&c) / (UINT32_MAX - 1.0));
+
+    void *valeurs = calloc(1, taille_quantifiee(c.n, format));
+    double *ligne = malloc((c.n > 0 ? c.n : 1) * sizeof(double));
+    if (valeurs == NULL || ligne == NULL) {
+        fprintf(stderr, "Erreur : impossible d'allouer la matrice des distances (%d sommets).\n", c.n);
+        exit(EXIT_FAILURE);
+    }
+    D.q = valeurs;
+    for (int s = 0; s < c.n; s++) {
+        dijkstra(&c, &s, 1, ligne, NULL);
+        for (int t = 0; t < c.n; t++) {
+            size_t i = indice_tuile(&D, s, t);
+            switch (format) {
+            case DIST_FLOAT:
+                ((float *)valeurs)[i] = (float)ligne[t];
+                break;
+            case DIST_U16:
+                ((uint16_t *)valeurs)[i] = isinf(ligne[t]) ? UINT16_MAX : (uint16_t)fmin(lround(ligne[t] / D.echelle), UINT16_MAX - 1);
+                break;
+            default:
+                ((uint32_t *)valeurs)[i] = isinf(ligne[t]) ? UINT32_MAX : (uint32_t)fmin(llround(ligne[t] / D.echelle), UINT32_MAX - 1.0);
+                break;
+            }
+        }
+    }
+
+    free(ligne);
+    free_csr(&c);
+    return D;
+}
+
+/* Projette le fichier cache s'il correspond au graphe (empreinte, taille,
+ * format) ; renvoie false sinon. */
+bool cache_ouvrir(char *cache_file, uint64_t empreinte, int n, FormatDistances format, Distances *D) {
+    int fd = open(cache_file, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    size_t attendue = sizeof(EnteteCache) + taille_quantifiee(n, format);
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != attendue) {
+        close(fd);
+        return false;
+    }
+    void *carte = mmap(NULL, attendue, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (carte == MAP_FAILED) return false;
+
+    const EnteteCache *entete = carte;
+    if (memcmp(entete->magique, MAGIQUE_CACHE, 8) != 0 || entete->version != VERSION_CACHE
+        || entete->format != (uint32_t)format || entete->empreinte != empreinte
+        || entete->n != n || entete->tuile != TUILE_DISTANCES) {
+        munmap(carte, attendue);
+        return false;
+    }
+
+    D->n = n;
+    D->d = NULL;
+    D->format = format;
+    D->echelle = entete->echelle;
+    D->q = (const char *)carte + sizeof(EnteteCache);
+    D->carte = carte;
+    D->taille_carte = attendue;
+    return true;
+}
+
+/* Écrit dans un fichier temporaire unique puis le renomme : une projection
+ * ouverte sur l'ancien cache reste valide, et deux processus qui écrivent le
+ * même cache ne se mélangent pas. */
+bool cache_ecrire(char *cache_file, uint64_t empreinte, Distances *D) {
+    char temporaire[1024];
+    snprintf(temporaire, sizeof(temporaire), "%s.XXXXXX", cache_file);
+    int fd = mkstemp(temporaire);
+    if (fd < 0) return false;
+    FILE *file = fdopen(fd, "wb");
+    if (file == NULL) {
+        close(fd);
+        remove(temporaire);
+        return false;
+    }
+
+    EnteteCache entete;
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.magique, MAGIQUE_CACHE, 8);
+    entete.version = VERSION_CACHE;
+    entete.format = D->format;
+    entete.empreinte = empreinte;
+    entete.n = D->n;
+    entete.tuile = TUILE_DISTANCES;
+    entete.echelle = D->echelle;
+
+    size_t taille = taille_quantifiee(D->n, D->format);
+    bool ok = fwrite(&entete, sizeof(entete), 1, file) == 1 && fwrite(D->q, 1, taille, file) == taille;
+    ok = (fclose(file) == 0) && ok;
+    if (ok) ok = rename(temporaire, cache_file) == 0;
+    if (!ok) remove(temporaire);
+    return ok;
+}
+
+/**
+ * Distances de g au format demandé, lues depuis le cache
+ * "<prefixe>-<empreinte>-<format>.cache" s'il existe, sinon calculées puis
+ * enregistrées. Chaque graphe a son propre fichier. Avec prefixe == NULL ou
+ * DIST_DOUBLE, équivaut à distances_calculer().
+ */
+Distances distances_charger(Graph *g, char *prefixe, FormatDistances format) {
+    if (prefixe == NULL || format == DIST_DOUBLE) return distances_calculer(g);
+
+    int n = vertices_count(g);
+    uint64_t empreinte = empreinte_graphe(g);
+    char *suffixes[] = { "f64", "f32", "u16", "u32" };
+    char cache_file[1024];
+    snprintf(cache_file, sizeof(cache_file), "%s-%016llx-%s.cache", prefixe, (unsigned long long)empreinte, suffixes[format]);
+    double mo = taille_quantifiee(n, format) / (1024.0 * 1024.0);
+    Distances D;
+    if (cache_ouvrir(cache_file, empreinte, n, format, &D)) {
+        printf("Distances lues depuis le cache %s (%.1f Mo)\n", cache_file, mo);
+        return D;
+    }
+
+    D = distances_quantifier(g, format);
+    if (!cache_ecrire(cache_file, empreinte, &D)) {
+        fprintf(stderr, "Erreur : impossible d'écrire le cache des distances %s, distances gardées en mémoire.\n", cache_file);
+        return D;
+    }
+    Distances projection;
+    if (cache_ouvrir(cache_file, empreinte, n, format, &projection)) {
+        free_distances(&D);
+        D = projection;
+    }
+    printf("Distances calculées et mises en cache dans %s (%.1f Mo au lieu de %.1f Mo", cache_file, mo,
+           (double)n * n * sizeof(double) / (1024.0 * 1024.0));
+    if (format == DIST_FLOAT) printf(", en float)\n");
+    else printf(", erreur <= %.1f m)\n", D.echelle * 500.0);
+    return D;
+}
+
+/* Remplace une matrice quantifiée (éventuellement projetée depuis le cache)
+ * par une matrice de double modifiable. */
+void distances_materialiser(Distances *D) {
+    if (D->format == DIST_DOUBLE) return;
+    Distances M = distances_init(D->n);
+    for (int i = 0; i < D->n; i++) {
+        for (int j = 0; j < D->n; j++) {
+            M.d[(size_t)i * M.n + j] = get_distance(D, i, j);
+        }
+    }
+    free_distances(D);
+    *D = M;
+}
+
+/**
+ * Indique si les distances depuis s peuvent changer quand le poids de l'arête
+ * a—b passe de ancien à nouveau (INFINITY = arête absente) :
+ * - hausse : seulement si l'arête est « tendue » depuis s, c'est-à-dire sur un
+ *   plus court chemin issu de s ;
+ * - baisse : seulement si la nouvelle arête raccourcit le chemin vers a ou b.
+ * Le test d'arête tendue tient compte de l'arrondi du format de D.
+ */
+bool source_affectee(Distances *D, int s, int a, int b, double ancien, double nouveau) {
+    double da = get_distance(D, s, a), db = get_distance(D, s, b);
+    return arete_affecte(da, db, ancien, nouveau, tolerance_distances(D, fmax(da, db)));
+}
+
+/* Erreur possible sur l'écart entre deux distances de D proches de d : un pas
+ * de quantification (echelle / 2 par valeur) ou la précision relative d'un float. */
+double tolerance_distances(Distances *D, double d) {
+    switch (D->format) {
+    case DIST_U16:
+    case DIST_U32:
+        return D->echelle;
+    case DIST_FLOAT:
+        return 2.0 * FLT_EPSILON * d;
+    default:
+        return 0.0;
+    }
+}
+
+/* Même test à partir des distances da et db de la source à a et à b, connues
+ * à tolerance près (0 pour des distances exactes). */
+bool arete_affecte(double da, double db, double ancien, double nouveau, double tolerance) {
+    if (nouveau > ancien) {
+        if (isinf(ancien) || isinf(da) || isinf(db)) return false;
+        return fabs(da + ancien - db) <= EPSILON_DISTANCE * (1.0 + db) + tolerance
+            || fabs(db + ancien - da) <= EPSILON_DISTANCE * (1.0 + da) + tolerance;
+    }
+    if (nouveau < ancien) {
+        return da + nouveau < db || db + nouveau < da;
+    }
+    return false;
+}
+
+typedef struct {
+    int a, b; // a <= b
+    int ordre; // Position dans le lot, pour garder la dernière modification d'une arête
+    double poids;
+} ModifTriee;
+
+int comparer_modifs(const void *x, const void *y) {
+    const ModifTriee *m1 = x, *m2 = y;
+    if (m1->a != m2->a) return m1->a - m2->a;
+    if (m1->b != m2->b) return m1->b - m2->b;
+    return m1->ordre - m2->ordre;
+}
+
+/**
+ * Applique un lot de modifications d'arêtes au graphe et répare la matrice D
+ * sans tout recalculer :
+ * 1. les sources dont un plus court chemin emprunte une arête allongée ou
+ *    supprimée sont recalculées par Dijkstra (et seulement elles) ;
+ * 2. les autres sources sont corrigées par un Dijkstra amorcé aux extrémités
+ *    des arêtes raccourcies ou ajoutées, limité aux sommets qui se rapprochent.
+ * Si une même arête apparaît plusieurs fois, seule la dernière modification
+ * compte. Renvoie le nombre de sources recalculées par Dijkstra.
+ */
+int distances_maj(Graph *g, Distances *D, ModifArete *modifs, int nb_modifs) {
+    int n = D->n;
+    assert(n == vertices_count(g));
+
+    ModifTriee *lot = malloc(nb_modifs * sizeof(ModifTriee));
+    for (int i = 0; i < nb_modifs; i++) {
+        assert(modifs[i].a >= 0 && modifs[i].a < n && modifs[i].b >= 0 && modifs[i].b < n);
+        lot[i].a = modifs[i].a < modifs[i].b ? modifs[i].a : modifs[i].b;
+        lot[i].b = modifs[i].a < modifs[i].b ? modifs[i].b : modifs[i].a;
+        lot[i].ordre = i;
+        lot[i].poids = modifs[i].poids;
+    }
+    qsort(lot, nb_modifs, sizeof(ModifTriee), comparer_modifs);
+
+    bool *a_recalculer = calloc(n, sizeof(bool));
+    ModifTriee *baisses = malloc(nb_modifs * sizeof(ModifTriee));
+    int nb_baisses = 0;
+
+    for (int i = 0; i < nb_modifs; i++) {
+        if (i + 1 < nb_modifs && lot[i+1].a == lot[i].a && lot[i+1].b == lot[i].b) continue;
+        int a = lot[i].a, b = lot[i].b;
+        double nouveau = lot[i].poids;
+        int eid = get_edge_id(g, a, b);
+        double ancien = (eid == -1) ? INFINITY : get_edge_attribute(g, eid, ATTR_WEIGHT);
+        if (nouveau == ancien) continue;
+
+        if (nouveau > ancien) {
+            for (int s = 0; s < n; s++) {
+                if (!a_recalculer[s] && source_affectee(D, s, a, b, ancien, nouveau)) {
+                    a_recalculer[s] = true;
+                }
+            }
+        } else {
+            baisses[nb_baisses++] = lot[i];
+        }
+
+        if (isinf(nouveau)) {
+            remove_edge(g, a, b);
+        } else if (eid == -1) {
+            add_edge(g, a, b, nouveau);
+        } else {
+            set_edge_attribute(g, eid, ATTR_WEIGHT, nouveau);
+        }
+    }
+
+    /* Les hausses sont détectées sur D dans son format d'origine, dont on
+     * connaît la précision ; les réparations se font en double */
+    distances_materialiser(D);
+
+    /* Étape 1 : sources touchées par une hausse (seule la ligne est écrite,
+     * la colonne l'est après l'étape 2) */
+    int nb_recalculees = 0;
+    Csr c = csr_from_graph(g);
+    for (int s = 0; s < n; s++) {
+        if (!a_recalculer[s]) continue;
+        dijkstra(&c, &s, 1, &D->d[(size_t)s * n], NULL);
+        nb_recalculees++;
+    }
+
+    /* Étape 2 : pour les autres sources, la ligne reste une borne supérieure
+     * exacte sauf pour les chemins qui empruntent une arête raccourcie ou
+     * ajoutée. Un Dijkstra amorcé aux extrémités de ces arêtes, et qui ne
+     * parcourt que les sommets qui se rapprochent, corrige la ligne. Chaque
+     * ligne n'est lue et écrite que par sa propre source, et les colonnes des
+     * sources recalculées ne sont pas encore écrites : une valeur déjà
+     * définitive bloquerait la propagation d'un raccourci au-delà. */
+    Tas tas = tas_init(64);
+    for (int s = 0; s < n && nb_baisses > 0; s++) {
+        if (a_recalculer[s]) continue;
+        double *ds = &D->d[(size_t)s * n];
+        for (int i = 0; i < nb_baisses; i++) {
+            int a = baisses[i].a, b = baisses[i].b;
+            double w = baisses[i].poids;
+            if (ds[a] + w < ds[b]) {
+                ds[b] = ds[a] + w;
+                tas_inserer(&tas, ds[b], b);
+            } else if (ds[b] + w < ds[a]) {
+                ds[a] = ds[b] + w;
+                tas_inserer(&tas, ds[a], a);
+            }
+        }
+        while (!tas_vide(&tas)) {
+            ElementTas min = tas_extraire(&tas);
+            int x = min.val;
+            if (min.cle > ds[x]) continue; // Entrée obsolète
+            for (int e = c.debut[x]; e < c.debut[x+1]; e++) {
+                double d = min.cle + c.poids[e];
+                if (d < ds[c.voisins[e]]) {
+                    ds[c.voisins[e]] = d;
+                    tas_inserer(&tas, d, c.voisins[e]);
+                }
+            }
+        }
+    }
+    free_tas(&tas);
+    free_csr(&c);
+
+    /* Étape 3 : graphe symétrique, les colonnes des sources recalculées
+     * reprennent leur ligne */
+    for (int s = 0; s < n; s++) {
+        if (!a_recalculer[s]) continue;
+        for (int t = 0; t < n; t++) D->d[(size_t)t * n + s] = D->d[(size_t)s * n + t];
+    }
+
+    printf("Mise à jour des distances : %d modification(s), %d source(s) recalculée(s) sur %d, %d arête(s) relâchée(s)\n",
+           nb_modifs, nb_recalculees, n, nb_baisses);
+
+    free(lot);
+    free(baisses);
+    free(a_recalculer);
+    return nb_recalculees;
+}
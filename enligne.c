@@ -0,0 +1,650 @@
+#include "tipe.h"
+
+/*
+ * Placement en ligne : la demande arrive au fil de l'eau (points de demande ou
+ * trajets) et des stations sont ajoutées au plan sans jamais déplacer celles
+ * déjà construites. Chaque demande de poids w en un sommet à distance δ de la
+ * station la plus proche ouvre une station sur place avec la probabilité
+ * min(1, w·δ / f), f étant le coût d'ouverture (algorithme de Meyerson).
+ *
+ * La distance de chaque sommet à la station la plus proche est tenue à jour :
+ * une demande coûte une lecture, une ouverture un Dijkstra limité aux sommets
+ * qui se rapprochent de la nouvelle station. Aucune de ces opérations ne
+ * dépend du nombre de demandes déjà reçues, qui ne sont conservées que sous
+ * forme de demande agrégée par sommet.
+ *
+ * Périodiquement, une consolidation par recherche locale ajoute des stations
+ * là où la demande est la plus mal servie, ferme ou déplace vers un voisin les
+ * stations prévues (pas encore construites) tant que le coût du plan
+ * (ouvertures + demande × distance) diminue.
+ */
+
+#define EPSILON_GAIN 1e-9
+
+struct PlanEnLigne_s {
+    Graph *g;
+    ParamEnLigne param;
+    Csr csr;
+    int n;
+    double *demande; // Demande agrégée de chaque sommet
+    double *proche; // Distance de chaque sommet à la station la plus proche
+    int *proprio; // Indice (dans stations) de cette station, -1 si aucune n'est accessible
+    int *stations;
+    bool *construite; // Station construite (fixe) ou seulement prévue
+    int nb_stations, capacite, nb_initiales;
+    int *indice; // Indice de la station placée sur chaque sommet, -1 sinon
+    Tas tas;
+    unsigned int graine;
+
+    /* Consolidation : cellules de Voronoï et distances candidates */
+    int *pred;
+    int *debut_cellule;
+    int *cellule;
+    double *nouvelle;
+    bool *touche;
+    int *touches;
+
+    long nb_demandes, ouvertures, ajouts, fermetures, deplacements;
+    double cout_affectation; // Somme des w·δ au moment de chaque demande
+};
+
+// ---- STATIONS ----
+
+/* Ajoute une station en v et rapproche d'elle les sommets pour lesquels elle
+ * devient la plus proche. */
+void plan_ouvrir(PlanEnLigne *p, int v, bool construite) {
+    if (p->nb_stations == p->capacite) {
+        p->capacite = p->capacite > 0 ? 2 * p->capacite : 16;
+        p->stations = realloc(p->stations, p->capacite * sizeof(int));
+        p->construite = realloc(p->construite, p->capacite * sizeof(bool));
+        if (p->stations == NULL || p->construite == NULL) {
+            fprintf(stderr, "Erreur : impossible d'agrandir le plan de stations.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    int j = p->nb_stations++;
+    p->stations[j] = v;
+    p->construite[j] = construite;
+    p->indice[v] = j;
+
+    Csr *c = &p->csr;
+    p->proche[v] = 0.0;
+    p->proprio[v] = j;
+    tas_inserer(&p->tas, 0.0, v);
+    while (!tas_vide(&p->tas)) {
+        ElementTas min = tas_extraire(&p->tas);
+        int x = min.val;
+        if (min.cle > p->proche[x]) continue; // Entrée obsolète
+        for (int e = c->debut[x]; e < c->debut[x+1]; e++) {
+            int y = c->voisins[e];
+            double d = min.cle + c->poids[e];
+            if (d < p->proche[y]) {
+                p->proche[y] = d;
+                p->proprio[y] = j;
+                tas_inserer(&p->tas, d, y);
+            }
+        }
+    }
+}
+
+/**
+ * Plan initialisé avec les stations existantes du graphe (construites, donc
+ * fixes) et une demande nulle.
+ */
+PlanEnLigne *plan_init(Graph *g, ParamEnLigne param) {
+    PlanEnLigne *p = calloc(1, sizeof(PlanEnLigne));
+    p->g = g;
+    p->param = param;
+    p->csr = csr_from_graph(g);
+    p->n = p->csr.n;
+    int n = p->n > 0 ? p->n : 1;
+    p->demande = calloc(n, sizeof(double));
+    p->proche = malloc(n * sizeof(double));
+    p->proprio = malloc(n * sizeof(int));
+    p->indice = malloc(n * sizeof(int));
+    p->pred = malloc(n * sizeof(int));
+    p->cellule = malloc(n * sizeof(int));
+    p->nouvelle = malloc(n * sizeof(double));
+    p->touche = calloc(n, sizeof(bool));
+    p->touches = malloc(n * sizeof(int));
+    p->tas = tas_init(64);
+    p->graine = param.graine;
+    for (int v = 0; v < p->n; v++) {
+        p->proche[v] = INFINITY;
+        p->proprio[v] = -1;
+        p->indice[v] = -1;
+    }
+    for (int v = 0; v < p->n; v++) {
+        if (get_station_status(g, v) == CHARGEUR) plan_ouvrir(p, v, true);
+    }
+    p->nb_initiales = p->nb_stations;
+    return p;
+}
+
+void free_plan(PlanEnLigne *p) {
+    free_csr(&p->csr);
+    free(p->demande);
+    free(p->proche);
+    free(p->proprio);
+    free(p->stations);
+    free(p->construite);
+    free(p->indice);
+    free_tas(&p->tas);
+    free(p->pred);
+    free(p->debut_cellule);
+    free(p->cellule);
+    free(p->nouvelle);
+    free(p->touche);
+    free(p->touches);
+    free(p);
+}
+
+/**
+ * Une demande de poids w au sommet v (règle de Meyerson). Renvoie true si une
+ * station a été ajoutée au plan.
+ */
+bool plan_demande(PlanEnLigne *p, int v, double w) {
+    if (v < 0 || v >= p->n || w <= 0.0) return false;
+    p->nb_demandes++;
+    p->demande[v] += w;
+
+    double delta = p->proche[v];
+    double u = (double)rand_r(&p->graine) / ((double)RAND_MAX + 1.0);
+    if (isinf(delta) || u < w * delta / p->param.cout_ouverture) {
+        plan_ouvrir(p, v, false);
+        p->ouvertures++;
+        return true;
+    }
+    p->cout_affectation += w * delta;
+    return false;
+}
+
+/* Les stations prévues deviennent construites (et fixes) et sont marquées
+ * comme chargeurs dans le graphe. */
+void plan_construire(PlanEnLigne *p) {
+    for (int j = 0; j < p->nb_stations; j++) {
+        if (p->construite[j]) continue;
+        p->construite[j] = true;
+        set_vertix_attribute(p->g, p->stations[j], ATTR_STATION, CHARGEUR);
+    }
+}
+
+/* Coût du plan : ouvertures des stations ajoutées + demande × distance. */
+double plan_cout(PlanEnLigne *p) {
+    double total = p->param.cout_ouverture * (p->nb_stations - p->nb_initiales);
+    for (int v = 0; v < p->n; v++) {
+        if (p->demande[v] > 0.0) total += p->demande[v] * p->proche[v];
+    }
+    return total;
+}
+
+// ---- CONSOLIDATION ----
+
+/* Distances exactes aux stations, propriétaires et cellules de Voronoï. */
+void plan_voronoi(PlanEnLigne *p) {
+    int n = p->n;
+    dijkstra(&p->csr, p->stations, p->nb_stations, p->proche, p->pred);
+
+    for (int v = 0; v < n; v++) p->proprio[v] = isinf(p->proche[v]) ? -1 : -2;
+    for (int j = 0; j < p->nb_stations; j++) p->proprio[p->stations[j]] = j;
+    for (int v = 0; v < n; v++) {
+        int u = v;
+        while (p->proprio[u] == -2) u = p->pred[u];
+        int j = p->proprio[u];
+        for (u = v; p->proprio[u] == -2; u = p->pred[u]) p->proprio[u] = j;
+    }
+
+    free(p->debut_cellule);
+    p->debut_cellule = calloc(p->nb_stations + 1, sizeof(int));
+    for (int v = 0; v < n; v++) {
+        if (p->proprio[v] >= 0) p->debut_cellule[p->proprio[v] + 1]++;
+    }
+    for (int j = 0; j < p->nb_stations; j++) p->debut_cellule[j+1] += p->debut_cellule[j];
+    int *pos = malloc((p->nb_stations > 0 ? p->nb_stations : 1) * sizeof(int));
+    memcpy(pos, p->debut_cellule, p->nb_stations * sizeof(int));
+    for (int v = 0; v < n; v++) {
+        if (p->proprio[v] >= 0) p->cellule[pos[p->proprio[v]]++] = v;
+    }
+    free(pos);
+}
+
+double plan_valeur(PlanEnLigne *p, int v, int j) {
+    if (p->touche[v]) return p->nouvelle[v];
+    return p->proprio[v] == j ? INFINITY : p->proche[v];
+}
+
+void plan_toucher(PlanEnLigne *p, int v, double d, int *nb_touches) {
+    if (!p->touche[v]) {
+        p->touche[v] = true;
+        p->touches[(*nb_touches)++] = v;
+    }
+    p->nouvelle[v] = d;
+}
+
+/* Variation exacte du coût d'affectation si la station j est déplacée en u
+ * (fermée si u = -1, ajoutée en u si j = -1), comme gain_deplacement() mais
+ * pondérée par la demande. */
+double plan_variation(PlanEnLigne *p, int j, int u) {
+    Csr *c = &p->csr;
+    int nb_touches = 0;
+
+    /* Sommets de la cellule de j : repartent des sommets voisins hors cellule */
+    for (int i = j >= 0 ? p->debut_cellule[j] : 0; j >= 0 && i < p->debut_cellule[j+1]; i++) {
+        int x = p->cellule[i];
+        for (int e = c->debut[x]; e < c->debut[x+1]; e++) {
+            int y = c->voisins[e];
+            if (p->proprio[y] == j || p->proprio[y] < 0) continue;
+            double d = p->proche[y] + c->poids[e];
+            if (d < plan_valeur(p, x, j)) {
+                plan_toucher(p, x, d, &nb_touches);
+                tas_inserer(&p->tas, d, x);
+            }
+        }
+    }
+    if (u >= 0 && 0.0 < plan_valeur(p, u, j)) {
+        plan_toucher(p, u, 0.0, &nb_touches);
+        tas_inserer(&p->tas, 0.0, u);
+    }
+
+    while (!tas_vide(&p->tas)) {
+        ElementTas min = tas_extraire(&p->tas);
+        int x = min.val;
+        if (min.cle > plan_valeur(p, x, j)) continue; // Entrée obsolète
+        for (int e = c->debut[x]; e < c->debut[x+1]; e++) {
+            int y = c->voisins[e];
+            double d = min.cle + c->poids[e];
+            if (d < plan_valeur(p, y, j)) {
+                plan_toucher(p, y, d, &nb_touches);
+                tas_inserer(&p->tas, d, y);
+            }
+        }
+    }
+
+    double delta = 0.0;
+    for (int i = j >= 0 ? p->debut_cellule[j] : 0; j >= 0 && i < p->debut_cellule[j+1]; i++) {
+        int x = p->cellule[i];
+        if (!p->touche[x] && p->demande[x] > 0.0) delta = INFINITY; // Demande désormais inaccessible
+    }
+    for (int i = 0; i < nb_touches; i++) {
+        int v = p->touches[i];
+        if (!isinf(delta)) delta += p->demande[v] * (p->nouvelle[v] - p->proche[v]);
+        p->touche[v] = false;
+    }
+    return delta;
+}
+
+/* Ajoute au plan, dans chaque cellule, le sommet qui y pèse le plus
+ * (demande × distance) si son ouverture fait baisser le coût du plan. */
+int plan_ajouter(PlanEnLigne *p) {
+    double f = p->param.cout_ouverture;
+    int nb_cellules = p->nb_stations, ajouts = 0;
+    int *candidats = malloc((nb_cellules > 0 ? nb_cellules : 1) * sizeof(int));
+    for (int j = 0; j < nb_cellules; j++) {
+        candidats[j] = -1;
+        double poids_max = 0.0;
+        for (int i = p->debut_cellule[j]; i < p->debut_cellule[j+1]; i++) {
+            int x = p->cellule[i];
+            if (p->demande[x] * p->proche[x] > poids_max) {
+                poids_max = p->demande[x] * p->proche[x];
+                candidats[j] = x;
+            }
+        }
+    }
+    for (int j = 0; j < nb_cellules; j++) {
+        int u = candidats[j];
+        if (u < 0 || p->indice[u] >= 0) continue;
+        if (plan_variation(p, -1, u) + f < -EPSILON_GAIN * (1.0 + f)) {
+            plan_ouvrir(p, u, false);
+            p->ajouts++;
+            ajouts++;
+        }
+    }
+    free(candidats);
+    if (ajouts > 0) plan_voronoi(p);
+    return ajouts;
+}
+
+/**
+ * Recherche locale sur les stations prévues : chaque cellule peut recevoir
+ * une station, chaque station prévue est fermée ou déplacée vers un sommet
+ * voisin, tant que le coût du plan diminue. Les stations construites ne
+ * bougent pas. Renvoie le nombre de modifications.
+ */
+int plan_consolider(PlanEnLigne *p) {
+    Csr *c = &p->csr;
+    double f = p->param.cout_ouverture;
+    int modifications = 0;
+    plan_voronoi(p);
+    for (int passe = 0; passe < PASSES_CONSOLIDATION; passe++) {
+        int ajouts = plan_ajouter(p);
+        modifications += ajouts;
+        bool ameliore = ajouts > 0;
+        for (int j = 0; j < p->nb_stations; j++) {
+            if (p->construite[j]) continue;
+
+            int s = p->stations[j];
+            int meilleur = -1;
+            double meilleur_delta = plan_variation(p, j, -1) - f;
+            for (int e = c->debut[s]; e < c->debut[s+1]; e++) {
+                int u = c->voisins[e];
+                if (p->indice[u] >= 0) continue;
+                double delta = plan_variation(p, j, u);
+                if (delta < meilleur_delta) {
+                    meilleur_delta = delta;
+                    meilleur = u;
+                }
+            }
+            if (meilleur_delta >= -EPSILON_GAIN * (1.0 + f)) continue;
+
+            p->indice[s] = -1;
+            if (meilleur < 0) {
+                /* Fermeture : la dernière station prend la place de j */
+                int dernier = --p->nb_stations;
+                p->stations[j] = p->stations[dernier];
+                p->construite[j] = p->construite[dernier];
+                if (j < dernier) p->indice[p->stations[j]] = j;
+                p->fermetures++;
+                j--;
+            } else {
+                p->stations[j] = meilleur;
+                p->indice[meilleur] = j;
+                p->deplacements++;
+            }
+            plan_voronoi(p);
+            modifications++;
+            ameliore = true;
+        }
+        if (!ameliore) break;
+    }
+    return modifications;
+}
+
+// ---- RÉFÉRENCE HORS LIGNE ----
+
+/* Coût d'un ensemble de stations pour la demande agrégée du plan. */
+double plan_evaluer(PlanEnLigne *p, int *stations, int nb, int nb_ajoutees, double *dist) {
+    double total = p->param.cout_ouverture * nb_ajoutees;
+    if (nb == 0) return p->nb_demandes > 0 ? INFINITY : total;
+    dijkstra(&p->csr, stations, nb, dist, NULL);
+    for (int v = 0; v < p->n; v++) {
+        if (p->demande[v] > 0.0) total += p->demande[v] * dist[v];
+    }
+    return total;
+}
+
+/**
+ * Solution hors ligne de référence, connaissant toute la demande : mêmes
+ * stations initiales, puis ajout glouton de la station qui fait le plus
+ * baisser le coût, puis suppression des ajouts devenus inutiles. Renvoie son
+ * coût ; *nb_ajoutees reçoit le nombre de stations ajoutées.
+ * Les distances exactes sont calculées depuis chaque sommet demandeur
+ * (graphe non orienté) et chaque étape gloutonne parcourt tous les couples
+ * (candidat, demandeur) : à réserver aux graphes de taille modeste.
+ */
+double plan_hors_ligne(PlanEnLigne *p, int *nb_ajoutees) {
+    int n = p->n;
+    double f = p->param.cout_ouverture;
+
+    int *clients = malloc(n * sizeof(int));
+    int nb_clients = 0;
+    for (int v = 0; v < n; v++) {
+        if (p->demande[v] > 0.0) clients[nb_clients++] = v;
+    }
+    double *lignes = malloc(((size_t)nb_clients * n > 0 ? (size_t)nb_clients * n : 1) * sizeof(double));
+    if (lignes == NULL) {
+        fprintf(stderr, "Erreur : mémoire insuffisante pour la solution hors ligne (%d demandeurs).\n", nb_clients);
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < nb_clients; i++) {
+        dijkstra(&p->csr, &clients[i], 1, &lignes[(size_t)i * n], NULL);
+    }
+
+    int *stations = malloc(n * sizeof(int));
+    int nb = 0;
+    bool *ouverte = calloc(n, sizeof(bool));
+    for (int j = 0; j < p->nb_initiales; j++) {
+        stations[nb++] = p->stations[j];
+        ouverte[p->stations[j]] = true;
+    }
+    double *dist = malloc(n * sizeof(double));
+    double *courante = malloc(n * sizeof(double));
+    for (int v = 0; v < n; v++) courante[v] = INFINITY;
+    if (nb > 0) dijkstra(&p->csr, stations, nb, courante, NULL);
+
+    while (nb < n) {
+        /* Priorité à la demande encore inaccessible, puis à l'économie */
+        int meilleur = -1;
+        double meilleurs_gagnes = 0.0, meilleure_economie = 0.0;
+        for (int s = 0; s < n; s++) {
+            if (ouverte[s]) continue;
+            double gagnes = 0.0, economie = -f;
+            for (int i = 0; i < nb_clients; i++) {
+                int v = clients[i];
+                double d = lignes[(size_t)i * n + s];
+                if (d >= courante[v]) continue;
+                if (isinf(courante[v])) {
+                    gagnes += p->demande[v];
+                    economie -= p->demande[v] * d;
+                } else {
+                    economie += p->demande[v] * (courante[v] - d);
+                }
+            }
+            if (gagnes > meilleurs_gagnes || (gagnes == meilleurs_gagnes && economie > meilleure_economie)) {
+                meilleurs_gagnes = gagnes;
+                meilleure_economie = economie;
+                meilleur = s;
+            }
+        }
+        if (meilleur < 0) break;
+        stations[nb++] = meilleur;
+        ouverte[meilleur] = true;
+        for (int i = 0; i < nb_clients; i++) {
+            int v = clients[i];
+            double d = lignes[(size_t)i * n + meilleur];
+            if (d < courante[v]) courante[v] = d;
+        }
+    }
+
+    /* Suppression des ajouts qui ne compensent plus leur coût d'ouverture */
+    double total = plan_evaluer(p, stations, nb, nb - p->nb_initiales, dist);
+    for (int i = nb - 1; i >= p->nb_initiales; i--) {
+        int s = stations[i];
+        stations[i] = stations[nb - 1];
+        double sans = plan_evaluer(p, stations, nb - 1, nb - 1 - p->nb_initiales, dist);
+        if (sans < total - EPSILON_GAIN) {
+            total = sans;
+            nb--;
+        } else {
+            stations[nb - 1] = stations[i];
+            stations[i] = s;
+        }
+    }
+    *nb_ajoutees = nb - p->nb_initiales;
+
+    free(lignes);
+    free(clients);
+    free(stations);
+    free(ouverte);
+    free(dist);
+    free(courante);
+    return total;
+}
+
+// ---- VÉRIFICATION ----
+
+/* Écart entre plan_variation(p, j, u) et le recalcul complet du coût
+ * d'affectation (base : coût actuel), relatif à base. */
+double ecart_variation(PlanEnLigne *p, int j, int u, double base, int *stations, double *dist) {
+    int nb = 0;
+    for (int i = 0; i < p->nb_stations; i++) {
+        if (i != j) stations[nb++] = p->stations[i];
+    }
+    if (u >= 0) stations[nb++] = u;
+    double attendu = plan_evaluer(p, stations, nb, 0, dist) - base;
+    double delta = plan_variation(p, j, u);
+    if (isinf(attendu) && isinf(delta)) return 0.0;
+    return isinf(attendu) || isinf(delta) ? INFINITY : fabs(delta - attendu) / fmax(1.0, base);
+}
+
+/**
+ * Plus grand écart relatif (voir verifier()) entre les distances tenues à jour
+ * par plan_ouvrir() et un Dijkstra complet, puis entre plan_variation() et le
+ * recalcul complet pour l'ajout d'une station sur chaque sommet libre, la
+ * fermeture de chaque station et son déplacement vers chaque voisin libre.
+ */
+double plan_verifier(PlanEnLigne *p) {
+    int n = p->n;
+    double *dist = malloc(n * sizeof(double));
+    int *stations = malloc((p->nb_stations + 1) * sizeof(int));
+    double ecart = 0.0;
+
+    double base = plan_evaluer(p, p->stations, p->nb_stations, 0, dist);
+    for (int v = 0; v < n && p->nb_stations > 0; v++) {
+        if (p->proche[v] != dist[v]) ecart = fmax(ecart, fabs(p->proche[v] - dist[v]) / fmax(1.0, dist[v]));
+    }
+
+    plan_voronoi(p);
+    for (int u = 0; u < n; u++) {
+        if (p->indice[u] < 0) ecart = fmax(ecart, ecart_variation(p, -1, u, base, stations, dist));
+    }
+    for (int j = 0; j < p->nb_stations; j++) {
+        int s = p->stations[j];
+        ecart = fmax(ecart, ecart_variation(p, j, -1, base, stations, dist));
+        for (int e = p->csr.debut[s]; e < p->csr.debut[s+1]; e++) {
+            int u = p->csr.voisins[e];
+            if (p->indice[u] < 0) ecart = fmax(ecart, ecart_variation(p, j, u, base, stations, dist));
+        }
+    }
+
+    free(dist);
+    free(stations);
+    return ecart;
+}
+
+// ---- PLACEMENT EN LIGNE ----
+
+/* Demande suivante : ligne "sommet[,poids]" ou trajet "depart,destination[,tour]"
+ * (la moitié de la demande à chaque extrémité), ou tirage selon la population. */
+int demande_suivante(FILE *file, ParamEnLigne *param, double *pop_cumulee, int n, unsigned int *graine, int *sommets, double *poids, long *invalides) {
+    if (file == NULL) {
+        sommets[0] = tirer_pondere(pop_cumulee, n, graine);
+        poids[0] = 1.0;
+        return 1;
+    }
+
+    char line[MAX_LINE_LENGTH];
+    while (fgets(line, MAX_LINE_LENGTH, file)) {
+        if (line[0] == CSV_SKIP_LINE || line[0] == '\n') continue;
+        if (param->trajets) {
+            if (sscanf(line, "%d , %d", &sommets[0], &sommets[1]) == 2
+                && sommets[0] >= 0 && sommets[0] < n && sommets[1] >= 0 && sommets[1] < n) {
+                poids[0] = poids[1] = 0.5;
+                return 2;
+            }
+        } else {
+            poids[0] = 1.0;
+            if (sscanf(line, "%d , %lf", &sommets[0], &poids[0]) >= 1 && sommets[0] >= 0 && sommets[0] < n) {
+                return 1;
+            }
+        }
+        (*invalides)++;
+    }
+    return 0;
+}
+
+/* Ligne du tableau des solutions ; le rapport n'est affiché qu'avec une
+ * référence hors ligne. */
+void afficher_solution(char *nom, long ajouts, double cout, double reference) {
+    printf("%-36s %8ld %16.0f", nom, ajouts, cout);
+    if (!isnan(reference)) printf(" %10.3f", cout / reference);
+    printf("\n");
+}
+
+/**
+ * Consomme un flux de demandes (fichier param.fichier, ou param.nb_demandes
+ * tirages selon la population), ajoute des stations au fil de l'eau et
+ * consolide le plan toutes les param.periode demandes. Affiche le coût en
+ * ligne et le temps par demande (et, avec param.reference, le rapport à une
+ * solution hors ligne), puis marque les stations du plan comme chargeurs.
+ */
+void placement_en_ligne(Graph *g, ParamEnLigne param) {
+    printf("\nPLACEMENT EN LIGNE (coût d'ouverture %.0f)\n\n", param.cout_ouverture);
+    int n = vertices_count(g);
+    if (param.cout_ouverture <= 0.0 || (param.fichier == NULL && param.nb_demandes <= 0) || n == 0) {
+        fprintf(stderr, "Erreur : paramètres du placement en ligne invalides.\n");
+        return;
+    }
+
+    FILE *file = NULL;
+    if (param.fichier != NULL) {
+        file = fopen(param.fichier, "r");
+        if (file == NULL) {
+            perror("Erreur d'ouverture du fichier de demandes");
+            return;
+        }
+    }
+    double *pop_cumulee = malloc(n * sizeof(double));
+    double cumul = 0.0;
+    for (int v = 0; v < n; v++) {
+        cumul += get_vertix_attribute(g, v, ATTR_POP);
+        pop_cumulee[v] = cumul;
+    }
+
+    PlanEnLigne *p = plan_init(g, param);
+    unsigned int graine = param.graine;
+    long invalides = 0, lues = 0;
+    int sommets[2];
+    double poids[2];
+
+    /* Temps par demande, par tranche de TRANCHE_EN_LIGNE demandes */
+    double temps_tranche = 0.0, temps_premiere = -1.0, temps_derniere = 0.0, temps_consolidation = 0.0;
+    long dans_tranche = 0;
+    int nb;
+    while ((param.fichier != NULL || lues < param.nb_demandes)
+           && (nb = demande_suivante(file, &param, pop_cumulee, n, &graine, sommets, poids, &invalides)) > 0) {
+        lues++;
+        double t0 = secondes();
+        for (int i = 0; i < nb; i++) {
+            plan_demande(p, sommets[i], poids[i]);
+        }
+        temps_tranche += secondes() - t0;
+        if (++dans_tranche == TRANCHE_EN_LIGNE) {
+            if (temps_premiere < 0.0) temps_premiere = temps_tranche / dans_tranche;
+            temps_derniere = temps_tranche / dans_tranche;
+            temps_tranche = 0.0;
+            dans_tranche = 0;
+        }
+
+        if (param.periode > 0 && lues % param.periode == 0) {
+            double t1 = secondes();
+            int modifications = plan_consolider(p);
+            temps_consolidation += secondes() - t1;
+            printf("%8ld demandes : %3d stations prévues, %d modifiées par la consolidation, coût du plan %.0f\n",
+                   lues, p->nb_stations - p->nb_initiales, modifications, plan_cout(p));
+        }
+    }
+    if (file != NULL) fclose(file);
+    if (dans_tranche > 0 && temps_premiere < 0.0) temps_premiere = temps_derniere = temps_tranche / dans_tranche;
+    double t1 = secondes();
+    plan_consolider(p);
+    temps_consolidation += secondes() - t1;
+
+    double f = param.cout_ouverture;
+    double en_ligne = p->cout_affectation + f * p->ouvertures;
+    double cout_plan = plan_cout(p);
+    int nb_hors_ligne = 0;
+    double hors_ligne = param.reference ? plan_hors_ligne(p, &nb_hors_ligne) : NAN;
+
+    printf("\nDemandes : %ld (%ld lignes invalides ignorées), %d stations existantes\n", lues, invalides, p->nb_initiales);
+    printf("Ouvertures en ligne : %ld / consolidation : %ld ajoutées, %ld fermées, %ld déplacées\n", p->ouvertures, p->ajouts, p->fermetures, p->deplacements);
+    printf("%-36s %8s %16s %10s\n", "Solution", "Ajouts", "Coût", param.reference ? "Rapport" : "");
+    afficher_solution("En ligne (affectations à l'arrivée)", p->ouvertures, en_ligne, hors_ligne);
+    afficher_solution("Plan consolidé", p->nb_stations - p->nb_initiales, cout_plan, hors_ligne);
+    if (param.reference) afficher_solution("Hors ligne (glouton + suppressions)", nb_hors_ligne, hors_ligne, hors_ligne);
+    printf("Temps par demande : %.2f µs (premières %d) / %.2f µs (dernières) ; consolidations : %.3f s\n",
+           temps_premiere * 1e6, TRANCHE_EN_LIGNE, temps_derniere * 1e6, temps_consolidation);
+
+    plan_construire(p);
+    free_plan(p);
+    free(pop_cumulee);
+}
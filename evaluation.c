@@ -0,0 +1,197 @@
+#include "tipe.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/*
+ * Évaluation en lot de placements de stations, sans simulation : chaque
+ * placement est noté par un unique Dijkstra multi-sources (toutes ses
+ * stations sont des sources), les placements étant répartis sur les cœurs.
+ */
+
+int nb_coeurs(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+/* Temps écoulé (horloge monotone), pour mesurer les calculs parallèles. */
+double secondes(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// ---- PLACEMENTS ----
+
+Placement placement_init(char *nom, int capacite) {
+    Placement p;
+    snprintf(p.nom, sizeof(p.nom), "%s", nom);
+    p.nb = 0;
+    p.sommets = malloc((capacite > 0 ? capacite : 1) * sizeof(int));
+    if (p.sommets == NULL) {
+        fprintf(stderr, "Erreur : impossible d'allouer le placement %s.\n", nom);
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/* Tire k sommets distincts (Fisher-Yates partiel). */
+Placement placement_aleatoire(int n, int k, unsigned int *graine, char *nom) {
+    if (k > n) k = n;
+    Placement p = placement_init(nom, k);
+    int *sommets = malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        sommets[i] = i;
+    }
+    for (int i = 0; i < k; i++) {
+        int j = i + rand_r(graine) % (n - i);
+        int tmp = sommets[i];
+        sommets[i] = sommets[j];
+        sommets[j] = tmp;
+        p.sommets[p.nb++] = sommets[i];
+    }
+    free(sommets);
+    return p;
+}
+
+/* Tire un indice avec une probabilité proportionnelle à son poids (cumul :
+ * sommes cumulées des poids), uniformément si tous les poids sont nuls. */
+int tirer_pondere(double *cumul, int n, unsigned int *graine) {
+    double total = cumul[n - 1];
+    if (total <= 0.0) return rand_r(graine) % n;
+    double r = ((double)rand_r(graine) / RAND_MAX) * total;
+    int bas = 0, haut = n - 1;
+    while (bas < haut) {
+        int milieu = (bas + haut) / 2;
+        if (r <= cumul[milieu]) haut = milieu;
+        else bas = milieu + 1;
+    }
+    return bas;
+}
+
+void free_placement(Placement *p) {
+    free(p->sommets);
+    p->sommets = NULL;
+    p->nb = 0;
+}
+
+// ---- ÉVALUATION ----
+
+void noter_placement(Csr *c, double *pop, Placement *p, double *dist, Score *score) {
+    score->cout = 0.0;
+    score->pire = 0.0;
+    score->couverture = 0.0;
+    if (p->nb == 0) {
+        score->cout = score->pire = INFINITY;
+        return;
+    }
+
+    dijkstra(c, p->sommets, p->nb, dist, NULL);
+
+    double pop_totale = 0.0, pop_couverte = 0.0;
+    for (int v = 0; v < c->n; v++) {
+        score->cout += dist[v];
+        if (dist[v] > score->pire) score->pire = dist[v];
+        pop_totale += pop[v];
+        if (dist[v] <= RAYON_COUVERTURE) pop_couverte += pop[v];
+    }
+    score->couverture = pop_totale > 0.0 ? 100.0 * pop_couverte / pop_totale : 0.0;
+}
+
+typedef struct {
+    Csr *csr;
+    double *pop;
+    Placement *placements;
+    Score *scores;
+    int nb;
+    int suivant; // Prochain placement à évaluer (partagé entre les threads)
+} TravailEvaluation;
+
+void *evaluer(void *arg) {
+    TravailEvaluation *t = arg;
+    double *dist = malloc(t->csr->n * sizeof(double));
+    int i;
+    while ((i = __atomic_fetch_add(&t->suivant, 1, __ATOMIC_RELAXED)) < t->nb) {
+        noter_placement(t->csr, t->pop, &t->placements[i], dist, &t->scores[i]);
+    }
+    free(dist);
+    return NULL;
+}
+
+void evaluer_placements(Graph *g, Placement *placements, int nb, Score *scores) {
+    Csr c = csr_from_graph(g);
+    double *pop = malloc(c.n * sizeof(double));
+    for (int v = 0; v < c.n; v++) {
+        pop[v] = get_vertix_attribute(g, v, ATTR_POP);
+    }
+
+    TravailEvaluation t = { &c, pop, placements, scores, nb, 0 };
+    int nb_threads = nb_coeurs() < nb ? nb_coeurs() : nb;
+    pthread_t *threads = malloc(nb_threads * sizeof(pthread_t));
+    for (int i = 0; i < nb_threads; i++) {
+        pthread_create(&threads[i], NULL, evaluer, &t);
+    }
+    for (int i = 0; i < nb_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+    free(pop);
+    free_csr(&c);
+}
+
+/**
+ * Placements de référence : stations officielles (rattachées aux sommets les
+ * plus proches), solutions du k-médian et nb_aleatoires placements aléatoires
+ * de même taille que le placement officiel. placements doit pouvoir contenir
+ * nb_aleatoires + 3 éléments ; renvoie le nombre de placements.
+ */
+int placements_reference(Graph *g, char *stations_file, int nb_aleatoires, Placement *placements) {
+    int n = vertices_count(g);
+    int nb = 0;
+
+    placements[nb++] = placement_from_csv(g, stations_file, "Stations officielles");
+    int k = placements[0].nb > 0 ? placements[0].nb : K;
+
+    Distances D = distances_charger(g, CACHE_DISTANCES, FORMAT_CACHE);
+    int tailles[2] = { k, K };
+    for (int i = 0; i < 2; i++) {
+        if (i == 1 && K == k) break;
+        char nom[64];
+        snprintf(nom, sizeof(nom), "k-médian (k=%d)", tailles[i]);
+        Placement p = placement_init(nom, tailles[i]);
+        kmedian_greedy(&D, tailles[i], p.sommets);
+        local_search(&D, tailles[i], p.sommets);
+        p.nb = tailles[i];
+        placements[nb++] = p;
+    }
+    free_distances(&D);
+
+    unsigned int graine = 1;
+    for (int i = 0; i < nb_aleatoires; i++) {
+        char nom[64];
+        snprintf(nom, sizeof(nom), "Aléatoire #%d", i + 1);
+        placements[nb++] = placement_aleatoire(n, k, &graine, nom);
+    }
+    return nb;
+}
+
+/* Compare les placements de référence sur le réseau tel quel. */
+void comparer_placements(Graph *g, char *stations_file, int nb_aleatoires) {
+    Placement *placements = malloc((nb_aleatoires + 3) * sizeof(Placement));
+    int nb = placements_reference(g, stations_file, nb_aleatoires, placements);
+
+    Score *scores = malloc(nb * sizeof(Score));
+    evaluer_placements(g, placements, nb, scores);
+
+    printf("\n%-24s %4s %14s %12s %12s\n", "Placement", "k", "Coût", "Pire (km)", "Couverture");
+    for (int i = 0; i < nb; i++) {
+        printf("%-24s %4d %14.2f %12.2f %11.2f%%\n", placements[i].nom, placements[i].nb,
+               scores[i].cout, scores[i].pire, scores[i].couverture);
+    }
+
+    for (int i = 0; i < nb; i++) {
+        free_placement(&placements[i]);
+    }
+    free(placements);
+    free(scores);
+}
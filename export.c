@@ -0,0 +1,377 @@
+#include "tipe.h"
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ * Export du graphe pour la visualisation (DOT, GeoJSON, SVG). Les attributs
+ * sont lus une seule fois depuis igraph dans des tableaux, puis écrits dans
+ * un fichier à gros tampon. Au-delà de SEUIL_LOD sommets, le dessin est
+ * simplifié : les sommets de faible degré sont regroupés par case d'une
+ * grille, les arêtes entre deux mêmes groupes fusionnées et les étiquettes
+ * de poids omises. Le rendu Graphviz tourne dans un processus détaché.
+ */
+
+#define TAMPON_EXPORT (1 << 20)
+
+typedef struct {
+    int n; // Nombre de nœuds dessinés
+    double *x, *y; // Longitude et latitude (ou disposition en cercle sans coordonnées)
+    bool coordonnees; // Les positions sont-elles géographiques ?
+    Station *type;
+    int *taille; // Nombre de sommets regroupés dans le nœud
+    int *id; // Sommet d'origine, ou -1 pour un groupe
+    double *pop;
+    int m;
+    int *a, *b;
+    double *poids;
+} Dessin;
+
+typedef struct {
+    uint64_t cle;
+    double poids;
+} AreteDessin;
+
+// ---- CONSTRUCTION DU DESSIN ----
+
+void lire_attribut(Graph *g, char *nom, double *valeurs, double defaut) {
+    int n = vertices_count(g);
+    if (!has_vertix_attribute(g, nom)) {
+        for (int i = 0; i < n; i++) valeurs[i] = defaut;
+        return;
+    }
+    Vector v;
+    init_vector(&v, n);
+    igraph_cattribute_VANV(g, nom, igraph_vss_all(), &v);
+    for (int i = 0; i < n; i++) valeurs[i] = VECTOR(v)[i];
+    igraph_vector_destroy(&v);
+}
+
+Dessin dessin_alloue(int n, int m) {
+    Dessin d;
+    d.n = n;
+    d.m = m;
+    d.x = malloc(n * sizeof(double));
+    d.y = malloc(n * sizeof(double));
+    d.type = malloc(n * sizeof(Station));
+    d.taille = malloc(n * sizeof(int));
+    d.id = malloc(n * sizeof(int));
+    d.pop = malloc(n * sizeof(double));
+    d.a = malloc((m > 0 ? m : 1) * sizeof(int));
+    d.b = malloc((m > 0 ? m : 1) * sizeof(int));
+    d.poids = malloc((m > 0 ? m : 1) * sizeof(double));
+    d.coordonnees = false;
+    return d;
+}
+
+void free_dessin(Dessin *d) {
+    free(d->x);
+    free(d->y);
+    free(d->type);
+    free(d->taille);
+    free(d->id);
+    free(d->pop);
+    free(d->a);
+    free(d->b);
+    free(d->poids);
+}
+
+int comparer_aretes_dessin(const void *x, const void *y) {
+    const AreteDessin *a = x, *b = y;
+    if (a->cle != b->cle) return (a->cle > b->cle) - (a->cle < b->cle);
+    return (a->poids > b->poids) - (a->poids < b->poids);
+}
+
+/* Regroupe les sommets ordinaires de faible degré par case de grille ; les
+ * stations et les carrefours (degré >= DEGRE_LOD) restent visibles. */
+Dessin simplifier(Dessin *complet, int *degre) {
+    int cotes = (int)ceil(sqrt((double)SEUIL_LOD));
+    double xmin = complet->x[0], xmax = xmin, ymin = complet->y[0], ymax = ymin;
+    for (int i = 1; i < complet->n; i++) {
+        if (complet->x[i] < xmin) xmin = complet->x[i];
+        if (complet->x[i] > xmax) xmax = complet->x[i];
+        if (complet->y[i] < ymin) ymin = complet->y[i];
+        if (complet->y[i] > ymax) ymax = complet->y[i];
+    }
+    double lx = (xmax - xmin) > 0 ? (xmax - xmin) : 1.0, ly = (ymax - ymin) > 0 ? (ymax - ymin) : 1.0;
+
+    int *noeud = malloc(complet->n * sizeof(int));
+    int *case_noeud = malloc((size_t)cotes * cotes * sizeof(int));
+    for (int c = 0; c < cotes * cotes; c++) case_noeud[c] = -1;
+
+    Dessin d = dessin_alloue(complet->n, complet->m);
+    d.coordonnees = true;
+    d.n = 0;
+    for (int i = 0; i < complet->n; i++) {
+        bool visible = complet->type[i] == CHARGEUR || degre[i] >= DEGRE_LOD;
+        int k;
+        if (visible) {
+            k = d.n++;
+            d.x[k] = d.y[k] = d.pop[k] = 0.0;
+            d.taille[k] = 0;
+            d.id[k] = i;
+            d.type[k] = complet->type[i];
+        } else {
+            int cx = (int)((complet->x[i] - xmin) / lx * (cotes - 1));
+            int cy = (int)((complet->y[i] - ymin) / ly * (cotes - 1));
+            int c = cy * cotes + cx;
+            if (case_noeud[c] == -1) {
+                k = case_noeud[c] = d.n++;
+                d.x[k] = d.y[k] = d.pop[k] = 0.0;
+                d.taille[k] = 0;
+                d.id[k] = -1;
+                d.type[k] = NORMAL;
+            }
+            k = case_noeud[c];
+        }
+        noeud[i] = k;
+        d.x[k] += complet->x[i];
+        d.y[k] += complet->y[i];
+        d.pop[k] += complet->pop[i];
+        d.taille[k]++;
+    }
+    for (int k = 0; k < d.n; k++) {
+        d.x[k] /= d.taille[k];
+        d.y[k] /= d.taille[k];
+        if (d.taille[k] == 1 && d.id[k] == -1) d.id[k] = -2; // Groupe d'un seul sommet : id inconnu ici
+    }
+    for (int i = 0; i < complet->n; i++) {
+        if (d.id[noeud[i]] == -2) d.id[noeud[i]] = i;
+    }
+
+    /* Arêtes entre nœuds : boucles supprimées, doublons fusionnés (poids minimal) */
+    AreteDessin *aretes = malloc((complet->m > 0 ? complet->m : 1) * sizeof(AreteDessin));
+    int nb = 0;
+    for (int e = 0; e < complet->m; e++) {
+        int a = noeud[complet->a[e]], b = noeud[complet->b[e]];
+        if (a == b) continue;
+        aretes[nb].cle = a < b ? ((uint64_t)a << 32) | (uint32_t)b : ((uint64_t)b << 32) | (uint32_t)a;
+        aretes[nb].poids = complet->poids[e];
+        nb++;
+    }
+    qsort(aretes, nb, sizeof(AreteDessin), comparer_aretes_dessin);
+    d.m = 0;
+    for (int e = 0; e < nb; e++) {
+        if (e > 0 && aretes[e].cle == aretes[e-1].cle) continue;
+        d.a[d.m] = (int)(aretes[e].cle >> 32);
+        d.b[d.m] = (int)(aretes[e].cle & 0xffffffffu);
+        d.poids[d.m] = aretes[e].poids;
+        d.m++;
+    }
+
+    free(aretes);
+    free(noeud);
+    free(case_noeud);
+    return d;
+}
+
+Dessin dessin_from_graph(Graph *g, bool *simplifie) {
+    int n = vertices_count(g), m = edges_count(g);
+    Dessin d = dessin_alloue(n, m);
+    double *station = malloc(n * sizeof(double));
+
+    d.coordonnees = has_vertix_attribute(g, ATTR_COORD_X) && has_vertix_attribute(g, ATTR_COORD_Y);
+    if (d.coordonnees) {
+        lire_attribut(g, ATTR_COORD_X, d.x, 0.0);
+        lire_attribut(g, ATTR_COORD_Y, d.y, 0.0);
+    } else {
+        for (int i = 0; i < n; i++) {
+            d.x[i] = cos(2 * M_PI * i / (n > 0 ? n : 1));
+            d.y[i] = sin(2 * M_PI * i / (n > 0 ? n : 1));
+        }
+    }
+    lire_attribut(g, ATTR_POP, d.pop, 0.0);
+    lire_attribut(g, ATTR_STATION, station, NORMAL);
+    for (int i = 0; i < n; i++) {
+        d.type[i] = station[i] == CHARGEUR ? CHARGEUR : NORMAL;
+        d.taille[i] = 1;
+        d.id[i] = i;
+    }
+    free(station);
+
+    igraph_vector_int_t aretes;
+    igraph_vector_int_init(&aretes, 0);
+    igraph_get_edgelist(g, &aretes, false);
+    Vector poids;
+    init_vector(&poids, m);
+    igraph_es_t es;
+    igraph_es_all(&es, IGRAPH_EDGEORDER_ID);
+    igraph_cattribute_EANV(g, ATTR_WEIGHT, es, &poids);
+    int *degre = calloc(n > 0 ? n : 1, sizeof(int));
+    for (int e = 0; e < m; e++) {
+        d.a[e] = (int)VECTOR(aretes)[2*e];
+        d.b[e] = (int)VECTOR(aretes)[2*e+1];
+        d.poids[e] = VECTOR(poids)[e];
+        degre[d.a[e]]++;
+        degre[d.b[e]]++;
+    }
+    igraph_vector_int_destroy(&aretes);
+    igraph_vector_destroy(&poids);
+    igraph_es_destroy(&es);
+
+    *simplifie = false;
+    if (n > SEUIL_LOD && d.coordonnees) {
+        Dessin simple = simplifier(&d, degre);
+        free_dessin(&d);
+        d = simple;
+        *simplifie = true;
+    }
+    free(degre);
+    return d;
+}
+
+// ---- FORMATS ----
+
+void ecrire_dot(Dessin *d, FILE *file, bool simplifie) {
+    fprintf(file, "graph {\n");
+    if (simplifie) fprintf(file, "  node [shape=point];\n");
+
+    for (int i = 0; i < d->n; i++) {
+        char *color = (d->type[i] == CHARGEUR) ? "red" : "lightgray";
+        if (d->coordonnees) {
+            int magnifiying_factor = 15;
+            fprintf(file, "  %d [pos=\"%.2f,%.2f!\", style=filled, color=%s", i,
+                    (d->x[i]*magnifiying_factor+104), (d->y[i]*magnifiying_factor-39), color);
+        } else {
+            fprintf(file, "  %d [style=filled, color=%s", i, color);
+        }
+        if (d->taille[i] > 1) fprintf(file, ", width=%.2f", 0.05 * sqrt((double)d->taille[i]));
+        fprintf(file, "];\n");
+    }
+
+    for (int e = 0; e < d->m; e++) {
+        if (simplifie) {
+            fprintf(file, "  %d -- %d;\n", d->a[e], d->b[e]);
+        } else {
+            fprintf(file, "  %d -- %d [label=\"%.2fkm\"];\n", d->a[e], d->b[e], d->poids[e]);
+        }
+    }
+
+    fprintf(file, "}\n");
+}
+
+void ecrire_geojson(Dessin *d, FILE *file) {
+    fprintf(file, "{\"type\":\"FeatureCollection\",\"features\":[\n");
+    for (int i = 0; i < d->n; i++) {
+        fprintf(file, "%s{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":[%.6f,%.6f]},"
+                "\"properties\":{\"id\":%d,\"population\":%.0f,\"station\":%s,\"sommets\":%d}}\n",
+                i > 0 ? "," : "", d->x[i], d->y[i], d->id[i], d->pop[i],
+                d->type[i] == CHARGEUR ? "true" : "false", d->taille[i]);
+    }
+    for (int e = 0; e < d->m; e++) {
+        fprintf(file, "%s{\"type\":\"Feature\",\"geometry\":{\"type\":\"LineString\",\"coordinates\":[[%.6f,%.6f],[%.6f,%.6f]]},"
+                "\"properties\":{\"poids\":%.2f}}\n",
+                d->n + e > 0 ? "," : "", d->x[d->a[e]], d->y[d->a[e]], d->x[d->b[e]], d->y[d->b[e]], d->poids[e]);
+    }
+    fprintf(file, "]}\n");
+}
+
+void ecrire_svg(Dessin *d, FILE *file) {
+    double largeur = 1000.0;
+    double xmin = 0, xmax = 1, ymin = 0, ymax = 1;
+    for (int i = 0; i < d->n; i++) {
+        if (i == 0 || d->x[i] < xmin) xmin = d->x[i];
+        if (i == 0 || d->x[i] > xmax) xmax = d->x[i];
+        if (i == 0 || d->y[i] < ymin) ymin = d->y[i];
+        if (i == 0 || d->y[i] > ymax) ymax = d->y[i];
+    }
+    /* Projection équirectangulaire : les longitudes sont resserrées par cos(latitude) */
+    double aplatissement = d->coordonnees ? cos((ymin + ymax) / 2 * M_PI / 180.0) : 1.0;
+    double lx = (xmax - xmin) * aplatissement > 0 ? (xmax - xmin) * aplatissement : 1.0;
+    double ly = (ymax - ymin) > 0 ? (ymax - ymin) : 1.0;
+    double echelle = largeur / lx;
+    double hauteur = ly * echelle;
+
+    fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"-10 -10 %.0f %.0f\">\n", largeur + 20, hauteur + 20);
+    fprintf(file, "<g stroke=\"gray\" stroke-width=\"0.5\">\n");
+    for (int e = 0; e < d->m; e++) {
+        int a = d->a[e], b = d->b[e];
+        fprintf(file, "<line x1=\"%.1f\" y1=\"%.1f\" x2=\"%.1f\" y2=\"%.1f\"/>\n",
+                (d->x[a] - xmin) * aplatissement * echelle, (ymax - d->y[a]) * echelle,
+                (d->x[b] - xmin) * aplatissement * echelle, (ymax - d->y[b]) * echelle);
+    }
+    fprintf(file, "</g>\n<g>\n");
+    for (int i = 0; i < d->n; i++) {
+        fprintf(file, "<circle cx=\"%.1f\" cy=\"%.1f\" r=\"%.1f\" fill=\"%s\"/>\n",
+                (d->x[i] - xmin) * aplatissement * echelle, (ymax - d->y[i]) * echelle,
+                (d->type[i] == CHARGEUR ? 4.0 : 2.0) * sqrt((double)d->taille[i]),
+                d->type[i] == CHARGEUR ? "red" : "lightgray");
+    }
+    fprintf(file, "</g>\n</svg>\n");
+}
+
+// ---- EXPORT ET RENDU ----
+
+void exporter_graphe(Graph *g, char *filename, FormatExport format) {
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) {
+        perror("Erreur lors de l'ouverture du fichier");
+        return;
+    }
+    char *tampon = malloc(TAMPON_EXPORT);
+    setvbuf(file, tampon, _IOFBF, TAMPON_EXPORT);
+
+    bool simplifie;
+    Dessin d = dessin_from_graph(g, &simplifie);
+    switch (format) {
+    case EXPORT_GEOJSON:
+        if (!d.coordonnees) fprintf(stderr, "Erreur : pas de coordonnées, positions GeoJSON arbitraires.\n");
+        ecrire_geojson(&d, file);
+        break;
+
+    case EXPORT_SVG:
+        ecrire_svg(&d, file);
+        break;
+
+    default:
+        ecrire_dot(&d, file, simplifie);
+        break;
+    }
+    if (simplifie) {
+        printf("Export simplifié de %s : %d sommets → %d nœuds, %d arêtes → %d\n",
+               filename, vertices_count(g), d.n, edges_count(g), d.m);
+    }
+
+    fclose(file);
+    free(tampon);
+    free_dessin(&d);
+}
+
+/* Lance Graphviz dans un processus détaché (double fork : pas de zombie, pas
+ * d'attente) puis ouvre l'image s'il y a un affichage. Les programmes sont
+ * lancés sans shell : les noms de fichiers sont passés tels quels. Sans effet
+ * si RENDU_GRAPHVIZ vaut 0. */
+void rendre_graphe(char *dot_file, char *image_file) {
+    if (!RENDU_GRAPHVIZ) return;
+
+    char *visionneuse = NULL;
+#ifdef __APPLE__
+    visionneuse = "open";
+#else
+    if (getenv("DISPLAY") != NULL || getenv("WAYLAND_DISPLAY") != NULL) visionneuse = "xdg-open";
+#endif
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (fork() == 0) {
+            /* neato, puis la visionneuse seulement si le rendu a réussi */
+            pid_t rendu = fork();
+            if (rendu == 0) {
+                execlp("neato", "neato", "-Tpng", dot_file, "-o", image_file, (char *)NULL);
+                _exit(127);
+            }
+            int statut;
+            if (rendu < 0 || waitpid(rendu, &statut, 0) < 0 || !WIFEXITED(statut) || WEXITSTATUS(statut) != 0) _exit(1);
+            if (visionneuse != NULL) execlp(visionneuse, visionneuse, image_file, (char *)NULL);
+            _exit(visionneuse != NULL ? 127 : 0);
+        }
+        _exit(0);
+    }
+    if (pid < 0) {
+        perror("Erreur lors du lancement de Graphviz");
+        return;
+    }
+    waitpid(pid, NULL, 0);
+    printf("Rendu de %s vers %s lancé en arrière-plan\n", dot_file, image_file);
+}
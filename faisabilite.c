@@ -0,0 +1,238 @@
+#include "tipe.h"
+
+/*
+ * Faisabilité analytique de tous les trajets origine-destination pour un
+ * ensemble de stations, sans simulation. Un trajet o → d est faisable s'il
+ * existe une suite o → s1 → ... → sk → d dont chaque étape (plus court
+ * chemin) se parcourt avec une batterie pleine. Les ensembles de stations
+ * sont des ensembles de bits :
+ * - A[v]  : stations à portée de v (une étape) ;
+ * - F[i]  : fermeture transitive du graphe des stations (Warshall par mots) ;
+ * - R[o]  : union des F[i] pour i dans A[o], stations atteignables depuis o ;
+ * o → d est alors faisable ssi d est à portée de o ou si R[o] ∩ A[d] ≠ ∅.
+ *
+ * La demande suit generer_trafic() : départ proportionnel à la population,
+ * destination uniforme. Contrairement à get_chemin(), qui choisit la station
+ * atteignable la plus éloignée, le résultat suppose un itinéraire optimal.
+ */
+
+bool etape_faisable(double d) {
+    return d * CONSOMMATION <= CAPACITE_BATTERIE;
+}
+
+void bits_ou(Mot *dst, const Mot *src, int mots) {
+    for (int i = 0; i < mots; i++) {
+        dst[i] |= src[i];
+    }
+}
+
+Faisabilite faisabilite_calculer(Distances *D, double *pop, int *stations, int nb_stations, bool details) {
+    int n = D->n;
+    int W = MOTS(nb_stations > 0 ? nb_stations : 1);
+    Faisabilite f = { n, NULL, NULL, 0.0, 0.0, 0.0 };
+
+    /* Stations à portée de chaque sommet */
+    Mot *A = calloc((size_t)n * W, sizeof(Mot));
+    for (int v = 0; v < n; v++) {
+        for (int i = 0; i < nb_stations; i++) {
+            if (etape_faisable(get_distance(D, v, stations[i]))) bit_mettre(&A[(size_t)v * W], i);
+        }
+    }
+
+    /* Fermeture transitive du graphe des stations */
+    Mot *F = calloc((size_t)nb_stations * W, sizeof(Mot));
+    for (int i = 0; i < nb_stations; i++) {
+        bits_ou(&F[(size_t)i * W], &A[(size_t)stations[i] * W], W);
+        bit_mettre(&F[(size_t)i * W], i);
+    }
+    for (int k = 0; k < nb_stations; k++) {
+        for (int i = 0; i < nb_stations; i++) {
+            if (bit_tester(&F[(size_t)i * W], k)) bits_ou(&F[(size_t)i * W], &F[(size_t)k * W], W);
+        }
+    }
+
+    /* Stations atteignables depuis chaque sommet */
+    Mot *R = calloc((size_t)n * W, sizeof(Mot));
+    for (int v = 0; v < n; v++) {
+        for (int w = 0; w < W; w++) {
+            Mot mot = A[(size_t)v * W + w];
+            while (mot) {
+                int i = w * 64 + __builtin_ctzll(mot);
+                mot &= mot - 1;
+                bits_ou(&R[(size_t)v * W], &F[(size_t)i * W], W);
+            }
+        }
+    }
+
+    /* Détails : plus courtes distances entre stations par étapes faisables
+     * (Floyd-Warshall) pour les détours, parcours en largeur pour les arrêts */
+    double *DS = NULL, *vers_d = NULL;
+    int *niveau = NULL, *file = NULL;
+    if (details) {
+        f.arrets = malloc((size_t)n * n * sizeof(unsigned char));
+        f.detour = malloc((size_t)n * n * sizeof(float));
+        DS = malloc((size_t)nb_stations * nb_stations * sizeof(double));
+        vers_d = malloc(nb_stations * sizeof(double));
+        niveau = malloc(nb_stations * sizeof(int));
+        file = malloc(nb_stations * sizeof(int));
+        for (int i = 0; i < nb_stations; i++) {
+            for (int j = 0; j < nb_stations; j++) {
+                double d = get_distance(D, stations[i], stations[j]);
+                DS[(size_t)i * nb_stations + j] = (i == j) ? 0.0 : (etape_faisable(d) ? d : INFINITY);
+            }
+        }
+        for (int k = 0; k < nb_stations; k++) {
+            for (int i = 0; i < nb_stations; i++) {
+                double dik = DS[(size_t)i * nb_stations + k];
+                if (isinf(dik)) continue;
+                for (int j = 0; j < nb_stations; j++) {
+                    double via = dik + DS[(size_t)k * nb_stations + j];
+                    if (via < DS[(size_t)i * nb_stations + j]) DS[(size_t)i * nb_stations + j] = via;
+                }
+            }
+        }
+    }
+
+    double demande_totale = 0.0, demande_echec = 0.0, demande_faisable = 0.0;
+    double somme_arrets = 0.0, somme_detours = 0.0;
+    for (int d = 0; d < n; d++) {
+        const Mot *Ad = &A[(size_t)d * W];
+        if (details) {
+            /* niveau[i] : nombre minimal d'étapes de station en station de i à une station à portée de d */
+            int tete = 0, queue = 0;
+            for (int i = 0; i < nb_stations; i++) {
+                niveau[i] = -1;
+                vers_d[i] = INFINITY;
+                if (bit_tester(Ad, i)) {
+                    niveau[i] = 0;
+                    file[queue++] = i;
+                }
+            }
+            while (tete < queue) {
+                int i = file[tete++];
+                const Mot *voisins = &A[(size_t)stations[i] * W];
+                for (int j = 0; j < nb_stations; j++) {
+                    if (niveau[j] == -1 && bit_tester(voisins, j)) {
+                        niveau[j] = niveau[i] + 1;
+                        file[queue++] = j;
+                    }
+                }
+            }
+            for (int t = 0; t < nb_stations; t++) {
+                if (!bit_tester(Ad, t)) continue;
+                double fin = get_distance(D, stations[t], d);
+                for (int i = 0; i < nb_stations; i++) {
+                    double via = DS[(size_t)i * nb_stations + t] + fin;
+                    if (via < vers_d[i]) vers_d[i] = via;
+                }
+            }
+        }
+
+        for (int o = 0; o < n; o++) {
+            size_t od = (size_t)o * n + d;
+            double direct = get_distance(D, o, d);
+            int arrets = ARRETS_IMPOSSIBLE;
+            double detour = INFINITY;
+
+            if (o == d || etape_faisable(direct)) {
+                arrets = 0;
+                detour = 0.0;
+            } else if (bits_intersectent(&R[(size_t)o * W], Ad, W)) {
+                arrets = 1;
+                if (details) {
+                    int meilleur_niveau = ARRETS_IMPOSSIBLE;
+                    double meilleure_longueur = INFINITY;
+                    for (int i = 0; i < nb_stations; i++) {
+                        if (!bit_tester(&A[(size_t)o * W], i)) continue;
+                        if (niveau[i] >= 0 && niveau[i] < meilleur_niveau) meilleur_niveau = niveau[i];
+                        double longueur = get_distance(D, o, stations[i]) + vers_d[i];
+                        if (longueur < meilleure_longueur) meilleure_longueur = longueur;
+                    }
+                    arrets = 1 + meilleur_niveau < ARRETS_IMPOSSIBLE ? 1 + meilleur_niveau : ARRETS_IMPOSSIBLE - 1;
+                    detour = meilleure_longueur - direct;
+                }
+            }
+
+            if (details) {
+                f.arrets[od] = (unsigned char)arrets;
+                f.detour[od] = (float)detour;
+            }
+            if (o == d || n < 2) continue;
+
+            double demande = pop[o] / (n - 1);
+            demande_totale += demande;
+            if (arrets == ARRETS_IMPOSSIBLE) {
+                demande_echec += demande;
+            } else {
+                demande_faisable += demande;
+                somme_arrets += demande * arrets;
+                if (details) somme_detours += demande * detour;
+            }
+        }
+    }
+
+    f.taux_echec = demande_totale > 0.0 ? 100.0 * demande_echec / demande_totale : 0.0;
+    if (demande_faisable > 0.0 && details) {
+        f.arrets_moyens = somme_arrets / demande_faisable;
+        f.detour_moyen = somme_detours / demande_faisable;
+    }
+
+    free(A);
+    free(F);
+    free(R);
+    free(DS);
+    free(vers_d);
+    free(niveau);
+    free(file);
+    return f;
+}
+
+void free_faisabilite(Faisabilite *f) {
+    free(f->arrets);
+    free(f->detour);
+    f->arrets = NULL;
+    f->detour = NULL;
+}
+
+void analyser_faisabilite(Graph *g) {
+    int n = vertices_count(g);
+    Distances D = distances_charger(g, CACHE_DISTANCES, FORMAT_CACHE);
+    int *stations = malloc(n * sizeof(int));
+    double *pop = malloc(n * sizeof(double));
+    int nb_stations = 0;
+    for (int v = 0; v < n; v++) {
+        if (get_station_status(g, v) == CHARGEUR) stations[nb_stations++] = v;
+        pop[v] = get_vertix_attribute(g, v, ATTR_POP);
+    }
+
+    clock_t debut = clock();
+    Faisabilite f = faisabilite_calculer(&D, pop, stations, nb_stations, true);
+    double duree = 1000.0 * (clock() - debut) / CLOCKS_PER_SEC;
+
+    /* Répartition de la demande selon le nombre d'arrêts (0, 1, 2, 3+, infaisable) */
+    double repartition[5] = { 0 };
+    double total = 0.0;
+    for (int o = 0; o < n; o++) {
+        for (int d = 0; d < n; d++) {
+            if (o == d) continue;
+            int arrets = f.arrets[(size_t)o * n + d];
+            int classe = arrets == ARRETS_IMPOSSIBLE ? 4 : (arrets > 3 ? 3 : arrets);
+            repartition[classe] += pop[o];
+            total += pop[o];
+        }
+    }
+
+    printf("Faisabilité de %d trajets origine-destination avec %d stations (%.2f ms)\n", n * (n - 1), nb_stations, duree);
+    printf("Trajets infaisables : %.2f %% de la demande\n", f.taux_echec);
+    printf("Arrêts de recharge moyens : %.2f / détour moyen : %.2f km (trajets faisables)\n", f.arrets_moyens, f.detour_moyen);
+    if (total > 0.0) {
+        printf("Demande : %.1f %% sans arrêt / %.1f %% 1 arrêt / %.1f %% 2 arrêts / %.1f %% 3+ arrêts / %.1f %% infaisable\n",
+               100 * repartition[0] / total, 100 * repartition[1] / total, 100 * repartition[2] / total,
+               100 * repartition[3] / total, 100 * repartition[4] / total);
+    }
+
+    free_faisabilite(&f);
+    free(stations);
+    free(pop);
+    free_distances(&D);
+}
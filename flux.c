@@ -0,0 +1,590 @@
+#include "tipe.h"
+#include <pthread.h>
+
+/*
+ * Simulation en flux (système ouvert) : au lieu de générer toute la flotte
+ * d'avance, les trajets sont lus (ou générés) par lots et traversent quatre
+ * étapes qui tournent en parallèle, reliées par des files bornées :
+ *
+ *   lecture → routage (NB_THREADS_ROUTAGE threads) → simulation → agrégation
+ *
+ * La simulation entretient un pool de param.taille_pool véhicules dont les
+ * emplacements sont recyclés dès qu'un véhicule arrive ou tombe en panne.
+ * La mémoire reste donc bornée quel que soit le nombre total de trajets.
+ * La recharge y est instantanée et les stations n'ont pas de bornes en
+ * nombre limité : les files d'attente ne sont modélisées que par simulation().
+ */
+
+#define EPSILON_CHEMIN 1e-9
+
+typedef struct {
+    int depart, destination;
+    long tour; // Tour de départ au plus tôt
+    int debut, longueur; // Itinéraire : sommets[debut..debut+longueur-1] du lot
+} Trajet;
+
+typedef struct {
+    long numero; // Rang du lot dans le flux, pour rendre les trajets dans l'ordre
+    int nb;
+    Trajet trajets[TAILLE_LOT];
+    int *sommets;
+    int nb_sommets, capacite_sommets;
+} LotTrajets;
+
+typedef struct {
+    Statut statut;
+    float distance;
+    long duree; // Nombre de tours sur le réseau
+    long attente; // Nombre de tours passés à attendre un emplacement libre
+} Bilan;
+
+typedef struct {
+    int nb;
+    Bilan bilans[TAILLE_LOT];
+} LotBilans;
+
+/* File bornée de lots. En mode ordonné, le lot numéro i occupe la case
+ * i % CAPACITE_FILE et n'est rendu qu'une fois tous les précédents rendus :
+ * les threads de routage peuvent finir dans le désordre sans que la mémoire
+ * ne dépasse CAPACITE_FILE lots. */
+typedef struct {
+    void *lots[CAPACITE_FILE];
+    long tete; // FIFO : indice du premier lot ; ordonné : numéro du prochain lot attendu
+    int nb;
+    int producteurs; // Nombre d'étapes qui alimentent encore la file
+    pthread_mutex_t verrou;
+    pthread_cond_t changement;
+} File;
+
+typedef struct {
+    ParamFlux param;
+    int n;
+    Csr csr;
+    Distances D;
+    int *stations; // Sommets équipés d'un chargeur
+    int nb_stations;
+    double *pop_cumulee;
+    File lus, routes, bilans;
+    StatistiquesFlux stats;
+} Flux;
+
+// ---- FILES ----
+
+void file_init(File *f, int producteurs) {
+    memset(f->lots, 0, sizeof(f->lots));
+    f->tete = 0;
+    f->nb = 0;
+    f->producteurs = producteurs;
+    pthread_mutex_init(&f->verrou, NULL);
+    pthread_cond_init(&f->changement, NULL);
+}
+
+void file_detruire(File *f) {
+    pthread_mutex_destroy(&f->verrou);
+    pthread_cond_destroy(&f->changement);
+}
+
+void file_fermer(File *f) {
+    pthread_mutex_lock(&f->verrou);
+    f->producteurs--;
+    pthread_cond_broadcast(&f->changement);
+    pthread_mutex_unlock(&f->verrou);
+}
+
+void file_deposer(File *f, void *lot) {
+    pthread_mutex_lock(&f->verrou);
+    while (f->nb == CAPACITE_FILE) {
+        pthread_cond_wait(&f->changement, &f->verrou);
+    }
+    f->lots[(f->tete + f->nb) % CAPACITE_FILE] = lot;
+    f->nb++;
+    pthread_cond_broadcast(&f->changement);
+    pthread_mutex_unlock(&f->verrou);
+}
+
+/* Renvoie NULL si la file est vide et que plus rien n'arrivera, ou si elle est
+ * vide et que l'appel n'est pas bloquant. */
+void *file_retirer(File *f, bool bloquant) {
+    pthread_mutex_lock(&f->verrou);
+    while (f->nb == 0 && f->producteurs > 0 && bloquant) {
+        pthread_cond_wait(&f->changement, &f->verrou);
+    }
+    void *lot = NULL;
+    if (f->nb > 0) {
+        lot = f->lots[f->tete];
+        f->tete = (f->tete + 1) % CAPACITE_FILE;
+        f->nb--;
+        pthread_cond_broadcast(&f->changement);
+    }
+    pthread_mutex_unlock(&f->verrou);
+    return lot;
+}
+
+void file_deposer_ordonne(File *f, void *lot, long numero) {
+    pthread_mutex_lock(&f->verrou);
+    while (numero >= f->tete + CAPACITE_FILE) {
+        pthread_cond_wait(&f->changement, &f->verrou);
+    }
+    f->lots[numero % CAPACITE_FILE] = lot;
+    pthread_cond_broadcast(&f->changement);
+    pthread_mutex_unlock(&f->verrou);
+}
+
+void *file_retirer_ordonne(File *f, bool bloquant) {
+    pthread_mutex_lock(&f->verrou);
+    int case_tete = f->tete % CAPACITE_FILE;
+    while (f->lots[case_tete] == NULL && f->producteurs > 0 && bloquant) {
+        pthread_cond_wait(&f->changement, &f->verrou);
+    }
+    void *lot = f->lots[case_tete];
+    if (lot != NULL) {
+        f->lots[case_tete] = NULL;
+        f->tete++;
+        pthread_cond_broadcast(&f->changement);
+    }
+    pthread_mutex_unlock(&f->verrou);
+    return lot;
+}
+
+// ---- ÉTAPE 1 : LECTURE / GÉNÉRATION ----
+
+LotTrajets *nouveau_lot(long numero) {
+    LotTrajets *lot = malloc(sizeof(LotTrajets));
+    if (lot == NULL) {
+        fprintf(stderr, "Erreur : impossible d'allouer un lot de trajets.\n");
+        exit(EXIT_FAILURE);
+    }
+    lot->numero = numero;
+    lot->nb = 0;
+    lot->sommets = NULL;
+    lot->nb_sommets = lot->capacite_sommets = 0;
+    return lot;
+}
+
+void free_lot(LotTrajets *lot) {
+    free(lot->sommets);
+    free(lot);
+}
+
+void *lecture(void *arg) {
+    Flux *f = arg;
+    long numero = 0;
+    LotTrajets *lot = nouveau_lot(numero++);
+
+    if (f->param.fichier != NULL) {
+        FILE *file = fopen(f->param.fichier, "r");
+        if (file == NULL) {
+            perror("Erreur d'ouverture du fichier de trajets");
+        } else {
+            char line[MAX_LINE_LENGTH];
+            while (fgets(line, MAX_LINE_LENGTH, file)) {
+                if (line[0] == CSV_SKIP_LINE || line[0] == '\n') continue;
+                int depart, destination;
+                long tour = 0;
+                if (sscanf(line, "%d , %d , %ld", &depart, &destination, &tour) < 2
+                    || depart < 0 || depart >= f->n || destination < 0 || destination >= f->n) {
+                    f->stats.invalides++;
+                    continue;
+                }
+                Trajet *t = &lot->trajets[lot->nb++];
+                t->depart = depart;
+                t->destination = destination;
+                t->tour = tour;
+                if (lot->nb == TAILLE_LOT) {
+                    file_deposer(&f->lus, lot);
+                    lot = nouveau_lot(numero++);
+                }
+            }
+            fclose(file);
+        }
+    } else {
+        unsigned int graine = f->param.graine;
+        double horloge = 0.0;
+        for (long i = 0; i < f->param.nb_trajets; i++) {
+            /* Inter-arrivées exponentielles : processus de Poisson de taux param.taux */
+            double u = ((double)rand_r(&graine) + 1.0) / ((double)RAND_MAX + 1.0);
+            horloge += -log(u) / f->param.taux;
+            Trajet *t = &lot->trajets[lot->nb++];
+            t->depart = tirer_pondere(f->pop_cumulee, f->n, &graine);
+            do {
+                t->destination = rand_r(&graine) % f->n;
+            } while (t->destination == t->depart);
+            t->tour = (long)horloge;
+            if (lot->nb == TAILLE_LOT) {
+                file_deposer(&f->lus, lot);
+                lot = nouveau_lot(numero++);
+            }
+        }
+    }
+
+    if (lot->nb > 0) {
+        file_deposer(&f->lus, lot);
+    } else {
+        free_lot(lot);
+    }
+    file_fermer(&f->lus);
+    return NULL;
+}
+
+// ---- ÉTAPE 2 : ROUTAGE ----
+
+void lot_ajouter_sommet(LotTrajets *lot, int s) {
+    if (lot->nb_sommets == lot->capacite_sommets) {
+        lot->capacite_sommets = lot->capacite_sommets > 0 ? 2 * lot->capacite_sommets : 8 * TAILLE_LOT;
+        lot->sommets = realloc(lot->sommets, lot->capacite_sommets * sizeof(int));
+        if (lot->sommets == NULL) {
+            fprintf(stderr, "Erreur : impossible d'agrandir les itinéraires du lot.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    lot->sommets[lot->nb_sommets++] = s;
+}
+
+/* Ajoute au lot le plus court chemin de u à t (u exclu), reconstruit saut par
+ * saut à partir de la matrice des distances. */
+void lot_ajouter_chemin(Flux *f, LotTrajets *lot, int u, int t) {
+    /* Avec des distances quantifiées, le voisin le plus proche de t est pris
+     * à l'erreur d'arrondi près ; le nombre de pas borne le chemin. */
+    double tolerance = f->D.format == DIST_U16 || f->D.format == DIST_U32 ? f->D.echelle : 0.0;
+    for (int pas = 0; u != t && pas < f->csr.n; pas++) {
+        double reste = get_distance(&f->D, u, t);
+        int suivant = -1;
+        double meilleur = INFINITY;
+        for (int e = f->csr.debut[u]; e < f->csr.debut[u+1]; e++) {
+            int v = f->csr.voisins[e];
+            double via = f->csr.poids[e] + get_distance(&f->D, v, t);
+            if (via < meilleur) {
+                meilleur = via;
+                suivant = v;
+            }
+        }
+        double ecart = EPSILON_CHEMIN * (1.0 + reste) + tolerance + (f->D.format == DIST_FLOAT ? reste * FLT_EPSILON * 2 : 0.0);
+        if (suivant == -1 || fabs(meilleur - reste) > ecart) return;
+        lot_ajouter_sommet(lot, suivant);
+        u = suivant;
+    }
+}
+
+/* Même stratégie que get_chemin() : aller au plus loin vers une station
+ * atteignable tant que la destination est hors d'autonomie. Une station n'est
+ * utilisée qu'une fois par trajet, ce qui garantit la terminaison. */
+void router_trajet(Flux *f, LotTrajets *lot, Trajet *t, bool *utilisee) {
+    t->debut = lot->nb_sommets;
+    lot_ajouter_sommet(lot, t->depart);
+
+    int courant = t->depart;
+    double batterie = CAPACITE_BATTERIE;
+    while (courant != t->destination) {
+        double reste = get_distance(&f->D, courant, t->destination);
+        if (isinf(reste)) break;
+        if (reste * CONSOMMATION <= batterie) {
+            lot_ajouter_chemin(f, lot, courant, t->destination);
+            break;
+        }
+
+        int best_station = -1;
+        double best_dist = -1.0;
+        for (int i = 0; i < f->nb_stations; i++) {
+            int s = f->stations[i];
+            double d = get_distance(&f->D, courant, s);
+            if (!utilisee[i] && d * CONSOMMATION <= batterie && d > best_dist) {
+                best_dist = d;
+                best_station = i;
+            }
+        }
+        if (best_station == -1) break; // Aucune station atteignable : trajet tronqué
+
+        utilisee[best_station] = true;
+        lot_ajouter_chemin(f, lot, courant, f->stations[best_station]);
+        courant = f->stations[best_station];
+        batterie = CAPACITE_BATTERIE;
+    }
+
+    t->longueur = lot->nb_sommets - t->debut;
+    memset(utilisee, 0, f->nb_stations * sizeof(bool));
+}
+
+void *routage(void *arg) {
+    Flux *f = arg;
+    bool *utilisee = calloc(f->nb_stations + 1, sizeof(bool));
+    LotTrajets *lot;
+    while ((lot = file_retirer(&f->lus, true)) != NULL) {
+        lot->nb_sommets = 0;
+        for (int i = 0; i < lot->nb; i++) {
+            router_trajet(f, lot, &lot->trajets[i], utilisee);
+        }
+        file_deposer_ordonne(&f->routes, lot, lot->numero);
+    }
+    free(utilisee);
+    file_fermer(&f->routes);
+    return NULL;
+}
+
+// ---- ÉTAPE 4 : AGRÉGATION ----
+
+void *agregation(void *arg) {
+    Flux *f = arg;
+    StatistiquesFlux *st = &f->stats;
+    LotBilans *lot;
+    while ((lot = file_retirer(&f->bilans, true)) != NULL) {
+        for (int i = 0; i < lot->nb; i++) {
+            Bilan *b = &lot->bilans[i];
+            st->trajets++;
+            st->distance += b->distance;
+            st->duree_totale += b->duree;
+            st->attente_totale += b->attente;
+            if (b->duree > st->duree_max) st->duree_max = b->duree;
+            switch (b->statut) {
+            case ARRIVE:
+                st->arrives++;
+                break;
+
+            case EN_PANNE:
+                st->pannes++;
+                break;
+
+            default:
+                st->autres++;
+                break;
+            }
+        }
+        free(lot);
+    }
+    return NULL;
+}
+
+// ---- ÉTAPE 3 : SIMULATION ----
+
+double poids_arete_csr(Csr *c, int u, int v) {
+    for (int e = c->debut[u]; e < c->debut[u+1]; e++) {
+        if (c->voisins[e] == v) return c->poids[e];
+    }
+    return -1.0;
+}
+
+/* Avance un véhicule d'une arête, comme simuler_tour() mais sans affichage. */
+void avancer_vehicule(Flux *f, Vehicule *v, bool *est_station) {
+    igraph_vector_int_t *chemin = &v->chemin;
+    if (v->etape + 1 >= igraph_vector_int_size(chemin)) {
+        v->statut = AUTRE;
+        return;
+    }
+
+    int prochain_sommet = (int)VECTOR(*chemin)[v->etape + 1];
+    double distance_arc = poids_arete_csr(&f->csr, v->position, prochain_sommet);
+    if (distance_arc < 0) {
+        v->statut = AUTRE;
+        return;
+    }
+
+    double conso = distance_arc * CONSOMMATION;
+    if (conso > v->batterie + 1e-9) {
+        v->statut = EN_PANNE;
+        return;
+    }
+
+    v->batterie -= conso;
+    v->distance += distance_arc;
+    v->position = prochain_sommet;
+    v->etape++;
+
+    if (est_station[prochain_sommet] && prochain_sommet != v->destination) {
+        v->batterie = CAPACITE_BATTERIE;
+    }
+    if (prochain_sommet == v->destination) {
+        v->statut = ARRIVE;
+    }
+}
+
+void emettre_bilan(Flux *f, LotBilans **lot, Statut statut, float distance, long duree, long attente) {
+    Bilan *b = &(*lot)->bilans[(*lot)->nb++];
+    b->statut = statut;
+    b->distance = distance;
+    b->duree = duree;
+    b->attente = attente;
+    if ((*lot)->nb == TAILLE_LOT) {
+        file_deposer(&f->bilans, *lot);
+        *lot = calloc(1, sizeof(LotBilans));
+    }
+}
+
+void simuler_flux(Flux *f) {
+    int taille_pool = f->param.taille_pool;
+    Vehicule *pool = malloc(taille_pool * sizeof(Vehicule));
+    long *depart_prevu = malloc(taille_pool * sizeof(long));
+    long *entree = malloc(taille_pool * sizeof(long));
+    int *libres = malloc(taille_pool * sizeof(int));
+    int *actifs = malloc(taille_pool * sizeof(int));
+    int nb_libres = taille_pool, nb_actifs = 0, max_actifs = 0;
+    for (int i = 0; i < taille_pool; i++) {
+        igraph_vector_int_init(&pool[i].chemin, 0);
+        libres[i] = taille_pool - 1 - i;
+    }
+
+    bool *est_station = calloc(f->n, sizeof(bool));
+    for (int i = 0; i < f->nb_stations; i++) {
+        est_station[f->stations[i]] = true;
+    }
+
+    LotBilans *bilans = calloc(1, sizeof(LotBilans));
+    LotTrajets *lot = NULL;
+    int idx = 0;
+    long tour = 0, id = 0;
+
+    while (true) {
+        /* Injection des trajets dont l'heure de départ est passée */
+        while (nb_libres > 0) {
+            if (lot == NULL || idx == lot->nb) {
+                if (lot != NULL) free_lot(lot);
+                lot = file_retirer_ordonne(&f->routes, nb_actifs == 0);
+                idx = 0;
+                if (lot == NULL) break;
+            }
+            Trajet *t = &lot->trajets[idx];
+            if (t->tour > tour) {
+                if (nb_actifs > 0) break;
+                tour = t->tour; // Réseau vide : on saute directement au prochain départ
+            }
+            idx++;
+            id++;
+
+            if (t->longueur <= 1) {
+                /* Trajet trivial ou sans itinéraire : aucun emplacement consommé */
+                emettre_bilan(f, &bilans, t->depart == t->destination ? ARRIVE : AUTRE, 0.0f, 0, tour - t->tour);
+                continue;
+            }
+
+            int slot = libres[--nb_libres];
+            Vehicule *v = &pool[slot];
+            v->id = (int)id;
+            v->depart = v->position = t->depart;
+            v->destination = t->destination;
+            v->batterie = CAPACITE_BATTERIE;
+            v->statut = EN_MARCHE;
+            v->distance = 0.0f;
+            v->attente = 0.0f;
+            v->etape = 0;
+            igraph_vector_int_resize(&v->chemin, t->longueur);
+            for (int k = 0; k < t->longueur; k++) {
+                VECTOR(v->chemin)[k] = lot->sommets[t->debut + k];
+            }
+            depart_prevu[slot] = t->tour;
+            entree[slot] = tour;
+            actifs[nb_actifs++] = slot;
+        }
+
+        if (nb_actifs == 0) break; // Flux épuisé
+        if (nb_actifs > max_actifs) max_actifs = nb_actifs;
+
+        /* Un tour : chaque véhicule actif avance d'une arête */
+        for (int i = 0; i < nb_actifs; i++) {
+            int slot = actifs[i];
+            Vehicule *v = &pool[slot];
+            avancer_vehicule(f, v, est_station);
+            if (v->statut != EN_MARCHE) {
+                emettre_bilan(f, &bilans, v->statut, v->distance, tour + 1 - entree[slot], entree[slot] - depart_prevu[slot]);
+                libres[nb_libres++] = slot;
+                actifs[i--] = actifs[--nb_actifs]; // Recyclage de l'emplacement
+            }
+        }
+        tour++;
+    }
+
+    if (bilans->nb > 0) {
+        file_deposer(&f->bilans, bilans);
+    } else {
+        free(bilans);
+    }
+    file_fermer(&f->bilans);
+
+    printf("Simulation en flux terminée en %ld tours (%d véhicules simultanés au maximum)\n", tour, max_actifs);
+
+    for (int i = 0; i < taille_pool; i++) {
+        igraph_vector_int_destroy(&pool[i].chemin);
+    }
+    free(pool);
+    free(depart_prevu);
+    free(entree);
+    free(libres);
+    free(actifs);
+    free(est_station);
+}
+
+// ---- SIMULATION EN FLUX ----
+
+void afficher_statistiques_flux(StatistiquesFlux *st) {
+    printf("Trajets simulés : %ld (%ld lignes invalides ignorées)\n", st->trajets, st->invalides);
+    printf("Total distance : %.2f km\n", st->distance);
+    printf("Total consommé : %.2f kWh\n", st->distance * CONSOMMATION);
+    printf("Total non-émis : %.2f kgCO2\n", (st->distance * CO2_EMIS) / 1000.0);
+    printf("Total statut : %ld arrivés / %ld en panne / %ld autre\n", st->arrives, st->pannes, st->autres);
+    if (st->trajets > 0) {
+        printf("Durée moyenne : %.2f tours (max %ld) / attente moyenne d'un emplacement : %.2f tours\n",
+               (double)st->duree_totale / st->trajets, st->duree_max, (double)st->attente_totale / st->trajets);
+    }
+}
+
+/* Renvoie le bilan de la simulation (nul en cas d'erreur). */
+StatistiquesFlux simulation_flux(Graph reseau, ParamFlux param) {
+    printf("Simulation en flux\n");
+    StatistiquesFlux stats;
+    memset(&stats, 0, sizeof(stats));
+    if (param.taille_pool <= 0 || (param.fichier == NULL && param.taux <= 0.0)) {
+        fprintf(stderr, "Erreur : paramètres de simulation en flux invalides.\n");
+        return stats;
+    }
+    if (vertices_count(&reseau) < 2) {
+        fprintf(stderr, "Erreur : le réseau doit contenir au moins deux sommets.\n");
+        return stats;
+    }
+
+    Flux *f = calloc(1, sizeof(Flux));
+    f->param = param;
+    f->n = vertices_count(&reseau);
+    f->csr = csr_from_graph(&reseau);
+    f->D = distances_charger(&reseau, CACHE_DISTANCES, FORMAT_CACHE);
+
+    f->stations = malloc(f->n * sizeof(int));
+    f->pop_cumulee = malloc(f->n * sizeof(double));
+    double cumul = 0.0;
+    for (int v = 0; v < f->n; v++) {
+        if (get_station_status(&reseau, v) == CHARGEUR) {
+            f->stations[f->nb_stations++] = v;
+        }
+        cumul += get_vertix_attribute(&reseau, v, ATTR_POP);
+        f->pop_cumulee[v] = cumul;
+    }
+
+    file_init(&f->lus, 1);
+    file_init(&f->routes, NB_THREADS_ROUTAGE);
+    file_init(&f->bilans, 1);
+
+    pthread_t lecteur, agregateur, routeurs[NB_THREADS_ROUTAGE];
+    pthread_create(&lecteur, NULL, lecture, f);
+    for (int i = 0; i < NB_THREADS_ROUTAGE; i++) {
+        pthread_create(&routeurs[i], NULL, routage, f);
+    }
+    pthread_create(&agregateur, NULL, agregation, f);
+
+    simuler_flux(f);
+
+    pthread_join(lecteur, NULL);
+    for (int i = 0; i < NB_THREADS_ROUTAGE; i++) {
+        pthread_join(routeurs[i], NULL);
+    }
+    pthread_join(agregateur, NULL);
+
+    printf("Fini!\n");
+    afficher_statistiques_flux(&f->stats);
+    stats = f->stats;
+
+    file_detruire(&f->lus);
+    file_detruire(&f->routes);
+    file_detruire(&f->bilans);
+    free_csr(&f->csr);
+    free_distances(&f->D);
+    free(f->stations);
+    free(f->pop_cumulee);
+    free(f);
+    return stats;
+}
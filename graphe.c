@@ -69,6 +69,17 @@ void add_edge(Graph *g, int a, int b, double weight) {
     set_edge_attribute(g, eid, ATTR_WEIGHT, weight);
 }
 
+void remove_edge(Graph *g, int a, int b) {
+    int eid = get_edge_id(g, a, b);
+    if (eid == -1) {
+        fprintf(stderr, "Erreur : aucune arête entre %d et %d à supprimer.\n", a, b);
+        return;
+    }
+    if (igraph_delete_edges(g, igraph_ess_1(eid)) != IGRAPH_SUCCESS) {
+        fprintf(stderr, "Erreur : impossible de supprimer l'arête entre %d et %d.\n", a, b);
+    }
+}
+
 void get_edge_vertices(Graph *g, int edge_id, int *from, int *to) {
     igraph_integer_t from_id, to_id;
     if (igraph_edge(g, edge_id, &from_id, &to_id) != IGRAPH_SUCCESS) {
@@ -136,50 +147,76 @@ void init_vector(Vector *v, int size) {
     }
 }
 
-// ----- VISUALISATION ------
+/* Distance à vol d'oiseau (en km) entre deux points donnés en degrés. */
+double haversine(double lon1, double lat1, double lon2, double lat2) {
+    double rad = M_PI / 180.0;
+    double dlat = (lat2 - lat1) * rad;
+    double dlon = (lon2 - lon1) * rad;
+    double a = sin(dlat / 2) * sin(dlat / 2) + cos(lat1 * rad) * cos(lat2 * rad) * sin(dlon / 2) * sin(dlon / 2);
+    return 2 * RAYON_TERRE * asin(sqrt(a));
+}
 
-void afficher_graphe(Graph *g, char *filename) {
-    FILE *file = fopen(filename, "w");
-    if (file == NULL) {
-        perror("Erreur lors de l'ouverture du fichier");
-        return;
+/* Copie le graphe au format CSR, sans igraph ni attributs : lecture rapide
+ * des voisins pour Dijkstra et utilisable depuis plusieurs threads. */
+Csr csr_from_graph(Graph *g) {
+    Csr c;
+    int n = vertices_count(g);
+    int m = edges_count(g);
+    c.n = n;
+    c.debut = calloc(n + 1, sizeof(int));
+    c.voisins = malloc(2 * m * sizeof(int));
+    c.poids = malloc(2 * m * sizeof(double));
+    if (c.debut == NULL || (m > 0 && (c.voisins == NULL || c.poids == NULL))) {
+        fprintf(stderr, "Erreur : impossible d'allouer le graphe CSR.\n");
+        exit(EXIT_FAILURE);
     }
 
-    fprintf(file, "graph {\n");
-
-    // Ajouter les sommets avec leurs positions et leurs couleurs
-    for (int i = 0; i < vertices_count(g); i++) {
-        Station type_station = get_vertix_attribute(g, i, ATTR_STATION);
-        char *color = (type_station == CHARGEUR) ? "red" : "lightgray";
-
-        if (has_vertix_attribute(g, ATTR_COORD_X) && has_vertix_attribute(g, ATTR_COORD_Y)) {
-            int magnifiying_factor = 15;
-            double x = get_vertix_attribute(g, i, ATTR_COORD_X);
-            double y = get_vertix_attribute(g, i, ATTR_COORD_Y);
-            fprintf(file, "  %d [pos=\"%.2f,%.2f!\", style=filled, color=%s];\n", i, (x*magnifiying_factor+104), (y*magnifiying_factor-39), color);
-        } else {
-            fprintf(file, "  %d [style=filled, color=%s];\n", i, color);
-        }
+    igraph_vector_int_t aretes;
+    igraph_vector_int_init(&aretes, 0);
+    igraph_get_edgelist(g, &aretes, false);
+    igraph_vector_t poids;
+    igraph_vector_init(&poids, 0);
+    igraph_es_t es;
+    igraph_es_all(&es, IGRAPH_EDGEORDER_ID);
+    igraph_cattribute_EANV(g, ATTR_WEIGHT, es, &poids);
+
+    for (int e = 0; e < m; e++) {
+        c.debut[VECTOR(aretes)[2*e] + 1]++;
+        c.debut[VECTOR(aretes)[2*e+1] + 1]++;
     }
-
-    // Ajouter les arêtes avec les poids comme labels
-    for (int i = 0; i < edges_count(g); i++) {
-        int from, to;
-        double poids = get_edge_attribute(g, i, ATTR_WEIGHT);
-        get_edge_vertices(g, i, &from, &to);
-        fprintf(file, "  %d -- %d [label=\"%.2fkm\"];\n", (int)from, (int)to, poids);
+    for (int i = 0; i < n; i++) {
+        c.debut[i+1] += c.debut[i];
     }
+    int *pos = malloc(n * sizeof(int));
+    memcpy(pos, c.debut, n * sizeof(int));
+    for (int e = 0; e < m; e++) {
+        int a = VECTOR(aretes)[2*e], b = VECTOR(aretes)[2*e+1];
+        c.voisins[pos[a]] = b;
+        c.poids[pos[a]++] = VECTOR(poids)[e];
+        c.voisins[pos[b]] = a;
+        c.poids[pos[b]++] = VECTOR(poids)[e];
+    }
+
+    free(pos);
+    igraph_vector_int_destroy(&aretes);
+    igraph_vector_destroy(&poids);
+    igraph_es_destroy(&es);
+    return c;
+}
 
-    fprintf(file, "}\n");
-    fclose(file);
+void free_csr(Csr *c) {
+    free(c->debut);
+    free(c->voisins);
+    free(c->poids);
+    c->debut = c->voisins = NULL;
+    c->poids = NULL;
+}
 
-    // Générer l'image avec Graphviz
-    char command[256];
-    snprintf(command, sizeof(command), "neato -Tpng %s -o output.png && open output.png", filename);
-    int ret = system(command);
-    if (ret != 0) {
-        fprintf(stderr, "Erreur lors de l'exécution de Graphviz\n");
-    }
+// ----- VISUALISATION ------
+
+void afficher_graphe(Graph *g, char *filename) {
+    exporter_graphe(g, filename, EXPORT_DOT);
+    rendre_graphe(filename, "output.png");
 }
 
 // ----- GRAPHES -----
@@ -0,0 +1,357 @@
+#include "tipe.h"
+#include <stdint.h>
+
+/*
+ * Construction d'un réseau routier approché : chaque sommet est relié à ses
+ * k plus proches voisins, trouvés avec un arbre k-d en O(n log n) au lieu du
+ * produit cartésien de colorado/extractor.py. Les points sont projetés sur la
+ * sphère unité (x, y, z) : la distance euclidienne y croît avec la distance
+ * à vol d'oiseau, donc les voisins trouvés sont exacts.
+ * Le poids d'une arête est la distance de haversine multipliée par un
+ * facteur de détour, sauf si une distance routière mesurée est fournie.
+ */
+
+typedef struct {
+    double p[3];
+    int id;
+} PointKd;
+
+typedef struct { // k meilleurs voisins, triés par distance croissante
+    int k, nb;
+    double *d2;
+    int *ids;
+} Voisins;
+
+// ---- ARBRE K-D ----
+
+/* Place en position m le point de rang m selon l'axe (sélection rapide). */
+void selection_kd(PointKd *pts, int lo, int hi, int m, int axe) {
+    while (hi - lo > 1) {
+        double pivot = pts[(lo + hi) / 2].p[axe];
+        int i = lo, j = hi - 1;
+        while (i <= j) {
+            while (pts[i].p[axe] < pivot) i++;
+            while (pts[j].p[axe] > pivot) j--;
+            if (i <= j) {
+                PointKd tmp = pts[i];
+                pts[i] = pts[j];
+                pts[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+        if (m <= j) hi = j + 1;
+        else if (m >= i) lo = i;
+        else return;
+    }
+}
+
+/* Arbre implicite : le nœud de [lo, hi) est le point médian, l'axe alterne
+ * avec la profondeur. */
+void construire_kd(PointKd *pts, int lo, int hi, int axe) {
+    if (hi - lo <= 1) return;
+    int m = (lo + hi) / 2;
+    selection_kd(pts, lo, hi, m, axe);
+    construire_kd(pts, lo, m, (axe + 1) % 3);
+    construire_kd(pts, m + 1, hi, (axe + 1) % 3);
+}
+
+void voisins_inserer(Voisins *v, double d2, int id) {
+    if (v->nb == v->k && d2 >= v->d2[v->nb - 1]) return;
+    int i = v->nb < v->k ? v->nb++ : v->nb - 1;
+    while (i > 0 && v->d2[i-1] > d2) {
+        v->d2[i] = v->d2[i-1];
+        v->ids[i] = v->ids[i-1];
+        i--;
+    }
+    v->d2[i] = d2;
+    v->ids[i] = id;
+}
+
+void chercher_kd(PointKd *pts, int lo, int hi, int axe, const PointKd *q, Voisins *v) {
+    if (hi <= lo) return;
+    int m = (lo + hi) / 2;
+    if (pts[m].id != q->id) {
+        double d2 = 0.0;
+        for (int a = 0; a < 3; a++) {
+            double diff = pts[m].p[a] - q->p[a];
+            d2 += diff * diff;
+        }
+        voisins_inserer(v, d2, pts[m].id);
+    }
+
+    double ecart = q->p[axe] - pts[m].p[axe];
+    int suivant = (axe + 1) % 3;
+    if (ecart < 0) {
+        chercher_kd(pts, lo, m, suivant, q, v);
+        if (v->nb < v->k || ecart * ecart < v->d2[v->nb - 1]) chercher_kd(pts, m + 1, hi, suivant, q, v);
+    } else {
+        chercher_kd(pts, m + 1, hi, suivant, q, v);
+        if (v->nb < v->k || ecart * ecart < v->d2[v->nb - 1]) chercher_kd(pts, lo, m, suivant, q, v);
+    }
+}
+
+/* Position du point (lon, lat) sur la sphère unité. */
+void projeter(double lon, double lat, double p[3]) {
+    double phi = lat * M_PI / 180.0, lambda = lon * M_PI / 180.0;
+    p[0] = cos(phi) * cos(lambda);
+    p[1] = cos(phi) * sin(lambda);
+    p[2] = sin(phi);
+}
+
+/* Plus proche point de q hors de la composante c ; *d2 et *id doivent valoir
+ * INFINITY et -1 au départ. */
+void chercher_hors_kd(PointKd *pts, int lo, int hi, int axe, const PointKd *q, const int *composante, int c,
+                      double *d2, int *id) {
+    if (hi <= lo) return;
+    int m = (lo + hi) / 2;
+    if (composante[pts[m].id] != c) {
+        double d = 0.0;
+        for (int a = 0; a < 3; a++) {
+            double diff = pts[m].p[a] - q->p[a];
+            d += diff * diff;
+        }
+        if (d < *d2) {
+            *d2 = d;
+            *id = pts[m].id;
+        }
+    }
+
+    double ecart = q->p[axe] - pts[m].p[axe];
+    int suivant = (axe + 1) % 3;
+    if (ecart < 0) {
+        chercher_hors_kd(pts, lo, m, suivant, q, composante, c, d2, id);
+        if (ecart * ecart < *d2) chercher_hors_kd(pts, m + 1, hi, suivant, q, composante, c, d2, id);
+    } else {
+        chercher_hors_kd(pts, m + 1, hi, suivant, q, composante, c, d2, id);
+        if (ecart * ecart < *d2) chercher_hors_kd(pts, lo, m, suivant, q, composante, c, d2, id);
+    }
+}
+
+// ---- DISTANCES ROUTIÈRES ----
+
+typedef struct {
+    uint64_t cle; // (min << 32) | max
+    double distance;
+} DistanceConnue;
+
+typedef struct {
+    double lon, lat;
+    int id;
+} Coordonnee;
+
+uint64_t cle_arete(int a, int b) {
+    return a < b ? ((uint64_t)a << 32) | (uint32_t)b : ((uint64_t)b << 32) | (uint32_t)a;
+}
+
+int comparer_cles(const void *x, const void *y) {
+    uint64_t a = *(const uint64_t *)x, b = *(const uint64_t *)y;
+    return (a > b) - (a < b);
+}
+
+int comparer_coordonnees(const void *x, const void *y) {
+    const Coordonnee *a = x, *b = y;
+    if (a->lon != b->lon) return (a->lon > b->lon) - (a->lon < b->lon);
+    return (a->lat > b->lat) - (a->lat < b->lat);
+}
+
+int trouver_coordonnee(Coordonnee *index, int n, double lon, double lat) {
+    Coordonnee cle = { lon, lat, -1 };
+    Coordonnee *c = bsearch(&cle, index, n, sizeof(Coordonnee), comparer_coordonnees);
+    return c != NULL ? c->id : -1;
+}
+
+/* Distances routières connues, triées par arête ; les tronçons dont une
+ * extrémité n'est pas un sommet sont ignorés. */
+DistanceConnue *indexer_troncons(int n, double *lon, double *lat, Troncon *troncons, int nb_troncons, int *nb_connues) {
+    Coordonnee *index = malloc(n * sizeof(Coordonnee));
+    for (int i = 0; i < n; i++) {
+        index[i].lon = lon[i];
+        index[i].lat = lat[i];
+        index[i].id = i;
+    }
+    qsort(index, n, sizeof(Coordonnee), comparer_coordonnees);
+
+    DistanceConnue *connues = malloc((nb_troncons > 0 ? nb_troncons : 1) * sizeof(DistanceConnue));
+    *nb_connues = 0;
+    for (int t = 0; t < nb_troncons; t++) {
+        int a = trouver_coordonnee(index, n, troncons[t].lon1, troncons[t].lat1);
+        int b = trouver_coordonnee(index, n, troncons[t].lon2, troncons[t].lat2);
+        if (a < 0 || b < 0 || a == b) continue;
+        connues[*nb_connues].cle = cle_arete(a, b);
+        connues[*nb_connues].distance = troncons[t].distance;
+        (*nb_connues)++;
+    }
+    qsort(connues, *nb_connues, sizeof(DistanceConnue), comparer_cles); // La clé est le premier champ
+
+    free(index);
+    return connues;
+}
+
+// ---- CONNEXITÉ ----
+
+int racine(int *parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+/**
+ * Un graphe des k plus proches voisins n'est pas forcément connexe (amas de
+ * villes éloignés les uns des autres), et cost() échoue alors. Tant qu'il
+ * reste plusieurs composantes, chacune sauf la plus grande est reliée par sa
+ * plus courte arête (à vol d'oiseau) vers une autre composante, comme une
+ * étape de Borůvka. Les arêtes sont ajoutées à la fin de *cles ; renvoie
+ * leur nombre.
+ */
+int relier_composantes(PointKd *pts, int n, double *lon, double *lat, uint64_t **cles, size_t *nb_aretes) {
+    int *parent = malloc(n * sizeof(int));
+    int *composante = malloc(n * sizeof(int));
+    int *taille = malloc(n * sizeof(int));
+    double *meilleure_d2 = malloc(n * sizeof(double));
+    uint64_t *meilleure = malloc(n * sizeof(uint64_t));
+    int ajoutees = 0;
+    while (true) {
+        for (int i = 0; i < n; i++) {
+            parent[i] = i;
+            taille[i] = 0;
+        }
+        for (size_t e = 0; e < *nb_aretes; e++) {
+            int a = racine(parent, (int)((*cles)[e] >> 32)), b = racine(parent, (int)((*cles)[e] & 0xffffffffu));
+            if (a != b) parent[a] = b;
+        }
+        int nb_composantes = 0, plus_grande = -1;
+        for (int i = 0; i < n; i++) {
+            composante[i] = racine(parent, i);
+            if (taille[composante[i]]++ == 0) nb_composantes++;
+            if (plus_grande == -1 || taille[composante[i]] > taille[plus_grande]) plus_grande = composante[i];
+        }
+        if (nb_composantes <= 1) break;
+
+        for (int c = 0; c < n; c++) meilleure_d2[c] = INFINITY;
+        for (int i = 0; i < n; i++) {
+            int c = composante[i];
+            if (c == plus_grande) continue;
+            PointKd q = { { 0 }, i };
+            projeter(lon[i], lat[i], q.p);
+            double d2 = INFINITY;
+            int id = -1;
+            chercher_hors_kd(pts, 0, n, 0, &q, composante, c, &d2, &id);
+            if (d2 < meilleure_d2[c]) {
+                meilleure_d2[c] = d2;
+                meilleure[c] = cle_arete(i, id);
+            }
+        }
+
+        /* Deux composantes peuvent choisir la même arête */
+        int nb = 0;
+        for (int c = 0; c < n; c++) {
+            if (c != plus_grande && taille[c] > 0) meilleure[nb++] = meilleure[c];
+        }
+        qsort(meilleure, nb, sizeof(uint64_t), comparer_cles);
+        *cles = realloc(*cles, (*nb_aretes + nb) * sizeof(uint64_t));
+        for (int i = 0; i < nb; i++) {
+            if (i > 0 && meilleure[i] == meilleure[i-1]) continue;
+            (*cles)[(*nb_aretes)++] = meilleure[i];
+            ajoutees++;
+        }
+    }
+    free(parent);
+    free(composante);
+    free(taille);
+    free(meilleure_d2);
+    free(meilleure);
+    return ajoutees;
+}
+
+// ---- CONSTRUCTION ----
+
+/**
+ * Construit le graphe des k plus proches voisins (relation symétrisée) des
+ * n points (lon, lat) de population pop, rendu connexe si besoin. troncons
+ * peut être NULL.
+ */
+Graph graph_knn(int n, double *lon, double *lat, double *pop, int k, double facteur_detour, Troncon *troncons, int nb_troncons) {
+    igraph_set_attribute_table(&igraph_cattribute_table);
+    if (k > n - 1) k = n - 1;
+
+    PointKd *pts = malloc(n * sizeof(PointKd));
+    for (int i = 0; i < n; i++) {
+        projeter(lon[i], lat[i], pts[i].p);
+        pts[i].id = i;
+    }
+    construire_kd(pts, 0, n, 0);
+
+    /* Voisins de chaque sommet, puis suppression des arêtes en double */
+    uint64_t *cles = malloc(((size_t)n * (k > 0 ? k : 1)) * sizeof(uint64_t));
+    size_t nb_cles = 0;
+    Voisins v = { k, 0, malloc((k + 1) * sizeof(double)), malloc((k + 1) * sizeof(int)) };
+    for (int i = 0; i < n && k > 0; i++) {
+        PointKd q = { { 0 }, i };
+        projeter(lon[i], lat[i], q.p);
+        v.nb = 0;
+        chercher_kd(pts, 0, n, 0, &q, &v);
+        for (int j = 0; j < v.nb; j++) {
+            cles[nb_cles++] = cle_arete(i, v.ids[j]);
+        }
+    }
+    qsort(cles, nb_cles, sizeof(uint64_t), comparer_cles);
+    size_t nb_aretes = 0;
+    for (size_t i = 0; i < nb_cles; i++) {
+        if (nb_aretes == 0 || cles[i] != cles[nb_aretes - 1]) cles[nb_aretes++] = cles[i];
+    }
+    int nb_liaisons = relier_composantes(pts, n, lon, lat, &cles, &nb_aretes);
+
+    int nb_connues = 0;
+    DistanceConnue *connues = indexer_troncons(n, lon, lat, troncons, troncons != NULL ? nb_troncons : 0, &nb_connues);
+
+    Graph g = init(n);
+    Vector valeurs;
+    init_vector(&valeurs, n);
+    for (int i = 0; i < n; i++) VECTOR(valeurs)[i] = lon[i];
+    set_vertix_attributes(&g, ATTR_LONG, &valeurs);
+    for (int i = 0; i < n; i++) VECTOR(valeurs)[i] = lat[i];
+    set_vertix_attributes(&g, ATTR_LAT, &valeurs);
+    for (int i = 0; i < n; i++) VECTOR(valeurs)[i] = pop != NULL ? pop[i] : 0.0;
+    set_vertix_attributes(&g, ATTR_POP, &valeurs);
+    for (int i = 0; i < n; i++) VECTOR(valeurs)[i] = NORMAL;
+    set_vertix_attributes(&g, ATTR_STATION, &valeurs);
+    igraph_vector_destroy(&valeurs);
+
+    igraph_vector_int_t aretes;
+    igraph_vector_int_init(&aretes, 2 * nb_aretes);
+    Vector poids;
+    init_vector(&poids, nb_aretes);
+    int nb_mesurees = 0;
+    for (size_t e = 0; e < nb_aretes; e++) {
+        int a = (int)(cles[e] >> 32), b = (int)(cles[e] & 0xffffffffu);
+        VECTOR(aretes)[2*e] = a;
+        VECTOR(aretes)[2*e+1] = b;
+        DistanceConnue *c = bsearch(&cles[e], connues, nb_connues, sizeof(DistanceConnue), comparer_cles);
+        if (c != NULL) {
+            VECTOR(poids)[e] = c->distance;
+            nb_mesurees++;
+        } else {
+            VECTOR(poids)[e] = haversine(lon[a], lat[a], lon[b], lat[b]) * facteur_detour;
+        }
+    }
+    igraph_add_edges(&g, &aretes, NULL);
+    set_edge_attributes(&g, ATTR_WEIGHT, &poids);
+
+    printf("Graphe des %d plus proches voisins : %d sommets, %zu arêtes (%d distances routières, %zu estimées)\n",
+           k, n, nb_aretes, nb_mesurees, nb_aretes - nb_mesurees);
+    if (nb_liaisons > 0) {
+        printf("Graphe non connexe : %d arête(s) ajoutée(s) entre composantes\n", nb_liaisons);
+    }
+
+    igraph_vector_int_destroy(&aretes);
+    igraph_vector_destroy(&poids);
+    free(connues);
+    free(v.d2);
+    free(v.ids);
+    free(cles);
+    free(pts);
+    return g;
+}
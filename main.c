@@ -1,6 +1,108 @@
 #include "tipe.h"
 
-int main(void) {
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "verifier") == 0) {
+        return verifier() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc > 1 && strcmp(argv[1], "flux") == 0) {
+        // ./tipe flux [trajets.csv] : trajets du fichier, sinon 100000 arrivées aléatoires
+        Graph graphe = get_colorado_graph();
+        attribuer_stations(&graphe);
+        ParamFlux param = { argc > 2 ? argv[2] : NULL, 100000, 20.0, 1, 4096 };
+        simulation_flux(graphe, param);
+        igraph_destroy(&graphe);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && strcmp(argv[1], "comparer") == 0) {
+        // ./tipe comparer [nb_aleatoires] : stations officielles, k-médian et placements aléatoires
+        Graph graphe = get_colorado_graph();
+        comparer_placements(&graphe, "colo_stations_official.csv", argc > 2 ? atoi(argv[2]) : 10);
+        igraph_destroy(&graphe);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && strcmp(argv[1], "knn") == 0) {
+        // ./tipe knn sommets.csv aretes.csv [routes.csv] : écrit les arêtes du graphe des plus proches voisins
+        if (argc < 4) {
+            fprintf(stderr, "Usage : %s knn sommets.csv aretes.csv [routes.csv]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        Graph graphe = graph_knn_from_csv(argv[2], K_VOISINS, FACTEUR_DETOUR, argc > 4 ? argv[4] : NULL);
+        graph_edges_to_csv(&graphe, argv[3]);
+        igraph_destroy(&graphe);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && strcmp(argv[1], "faisabilite") == 0) {
+        // ./tipe faisabilite : trajets faisables avec les stations du k-médian
+        Graph graphe = get_colorado_graph();
+        attribuer_stations(&graphe);
+        analyser_faisabilite(&graphe);
+        igraph_destroy(&graphe);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && strcmp(argv[1], "exporter") == 0) {
+        // ./tipe exporter fichier [dot|geojson|svg] : réseau du Colorado et stations du k-médian
+        if (argc < 3) {
+            fprintf(stderr, "Usage : %s exporter fichier [dot|geojson|svg]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        char *format = argc > 3 ? argv[3] : "dot";
+        Graph graphe = get_colorado_graph();
+        attribuer_stations(&graphe);
+        if (strcmp(format, "geojson") == 0) {
+            exporter_graphe(&graphe, argv[2], EXPORT_GEOJSON);
+        } else if (strcmp(format, "svg") == 0) {
+            exporter_graphe(&graphe, argv[2], EXPORT_SVG);
+        } else {
+            afficher_graphe(&graphe, argv[2]);
+        }
+        igraph_destroy(&graphe);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && strcmp(argv[1], "regions") == 0) {
+        // ./tipe regions [k] [nb_regions] : k-médian par régions sur le réseau du Colorado
+        Graph graphe = get_colorado_graph();
+        int k = argc > 2 ? atoi(argv[2]) : K;
+        int *centres = malloc((k > 0 ? k : 1) * sizeof(int));
+        kmedian_regions(&graphe, k, argc > 3 ? atoi(argv[3]) : 4, centres);
+        free(centres);
+        igraph_destroy(&graphe);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && strcmp(argv[1], "captage") == 0) {
+        // ./tipe captage [k] : stations captant le plus de trajets longs sur le réseau du Colorado
+        Graph graphe = get_colorado_graph();
+        int k = argc > 2 ? atoi(argv[2]) : K;
+        int *stations = malloc((k > 0 ? k : 1) * sizeof(int));
+        captage_placement(&graphe, k, stations);
+        free(stations);
+        igraph_destroy(&graphe);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && strcmp(argv[1], "robustesse") == 0) {
+        // ./tipe robustesse [nb_scenarios] : placements de référence sur des scénarios perturbés
+        Graph graphe = get_colorado_graph();
+        ParamScenarios p = { argc > 2 ? atoi(argv[2]) : 1000, 1, 0.02, 0.1, 2.0, 0.1 };
+        comparer_robustesse(&graphe, "colo_stations_official.csv", 5, p);
+        igraph_destroy(&graphe);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && strcmp(argv[1], "reparti") == 0) {
+        // ./tipe reparti [nb_processus] [trajets.csv] : simulation en flux répartie sur plusieurs processus
+        Graph graphe = get_colorado_graph();
+        attribuer_stations(&graphe);
+        ParamFlux param = { argc > 3 ? argv[3] : NULL, 100000, 20.0, 1, 4096 };
+        simulation_repartie(graphe, param, argc > 2 ? atoi(argv[2]) : 4);
+        igraph_destroy(&graphe);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && strcmp(argv[1], "enligne") == 0) {
+        // ./tipe enligne [cout_ouverture] [demandes.csv] : placement en ligne, comparé à la solution hors ligne
+        Graph graphe = get_colorado_graph();
+        ParamEnLigne param = { argc > 3 ? argv[3] : NULL, false, 100000, argc > 2 ? atof(argv[2]) : 100000.0, 10000, 1, true };
+        placement_en_ligne(&graphe, param);
+        igraph_destroy(&graphe);
+        return EXIT_SUCCESS;
+    }
     //Graph graphe = get_colorado_graph();
     Graph graphe = get_random_graph(10);
     attribuer_stations(&graphe);
@@ -0,0 +1,502 @@
+#include "tipe.h"
+#include <pthread.h>
+
+/*
+ * k-médian par décomposition en régions, pour les graphes trop grands pour
+ * une matrice des distances globale :
+ * 1. bissection récursive selon les coordonnées (ATTR_LONG / ATTR_LAT) en
+ *    nb_regions régions de tailles voisines ;
+ * 2. répartition des k stations au prorata de la population des régions
+ *    (méthode du plus fort reste) ;
+ * 3. glouton + recherche locale dans chaque région, une région par thread,
+ *    sur la matrice des distances du sous-graphe induit ;
+ * 4. réparation aux frontières : les centres dont la cellule de Voronoï
+ *    déborde de leur région sont déplacés vers un voisin tant que le coût
+ *    global diminue. Le gain d'un déplacement est calculé exactement par un
+ *    Dijkstra limité à la cellule du centre et aux sommets qui se
+ *    rapprochent du nouveau centre.
+ */
+
+#define EPSILON_GAIN 1e-9
+
+typedef struct {
+    double cle;
+    int id;
+} SommetTrie;
+
+typedef struct {
+    Csr *csr;
+    int *region; // Région de chaque sommet
+    int *local; // Indice de chaque sommet dans sa région
+    int *debut; // Sommets de la région r : sommets[debut[r] .. debut[r+1]-1]
+    int *sommets;
+    int *budget;
+    int *centres; // Centres de la région r : centres[premier[r] ..]
+    int *premier;
+    int nb_regions;
+    int suivant; // Prochaine région à résoudre (partagé entre les threads)
+} TravailRegions;
+
+// ---- DÉCOUPAGE ----
+
+int comparer_sommets_tries(const void *x, const void *y) {
+    const SommetTrie *a = x, *b = y;
+    if (a->cle != b->cle) return (a->cle > b->cle) - (a->cle < b->cle);
+    return a->id - b->id;
+}
+
+/* Coupe ids[0..nb) selon l'axe le plus étendu, en deux parts proportionnelles
+ * au nombre de régions de chaque côté. */
+void bissection(int *ids, int nb, double *lon, double *lat, int nb_regions, int premiere, int *region, SommetTrie *tmp) {
+    if (nb_regions <= 1 || nb <= 1) {
+        for (int i = 0; i < nb; i++) region[ids[i]] = premiere;
+        return;
+    }
+
+    double xmin = INFINITY, xmax = -INFINITY, ymin = INFINITY, ymax = -INFINITY;
+    for (int i = 0; i < nb; i++) {
+        if (lon[ids[i]] < xmin) xmin = lon[ids[i]];
+        if (lon[ids[i]] > xmax) xmax = lon[ids[i]];
+        if (lat[ids[i]] < ymin) ymin = lat[ids[i]];
+        if (lat[ids[i]] > ymax) ymax = lat[ids[i]];
+    }
+    bool selon_lon = (xmax - xmin) * cos((ymin + ymax) / 2 * M_PI / 180.0) >= ymax - ymin;
+    for (int i = 0; i < nb; i++) {
+        tmp[i].cle = selon_lon ? lon[ids[i]] : lat[ids[i]];
+        tmp[i].id = ids[i];
+    }
+    qsort(tmp, nb, sizeof(SommetTrie), comparer_sommets_tries);
+    for (int i = 0; i < nb; i++) ids[i] = tmp[i].id;
+
+    int gauche = nb_regions / 2;
+    int coupe = (int)((long)nb * gauche / nb_regions);
+    bissection(ids, coupe, lon, lat, gauche, premiere, region, tmp);
+    bissection(ids + coupe, nb - coupe, lon, lat, nb_regions - gauche, premiere + gauche, region, tmp);
+}
+
+/* Répartit les sommets en nb_regions régions de tailles voisines : bissection
+ * selon les coordonnées, ou tranches de numéros consécutifs sans coordonnées. */
+void decouper_regions(Graph *g, int nb_regions, int *region) {
+    int n = vertices_count(g);
+    if (nb_regions < 1) nb_regions = 1;
+    if (!has_vertix_attribute(g, ATTR_LONG) || !has_vertix_attribute(g, ATTR_LAT)) {
+        for (int v = 0; v < n; v++) region[v] = (int)((long)v * nb_regions / n);
+        return;
+    }
+
+    double *lon = malloc(n * sizeof(double));
+    double *lat = malloc(n * sizeof(double));
+    int *ids = malloc(n * sizeof(int));
+    SommetTrie *tmp = malloc(n * sizeof(SommetTrie));
+    for (int v = 0; v < n; v++) {
+        lon[v] = get_vertix_attribute(g, v, ATTR_LONG);
+        lat[v] = get_vertix_attribute(g, v, ATTR_LAT);
+        ids[v] = v;
+    }
+    bissection(ids, n, lon, lat, nb_regions, 0, region, tmp);
+    free(lon);
+    free(lat);
+    free(ids);
+    free(tmp);
+}
+
+/* Plus fort reste : budget[r] ≈ k · pop[r] / pop totale, sans dépasser la
+ * taille de la région. */
+void repartir_budget(int k, double *pop, int *taille, int nb_regions, int *budget) {
+    /* Sans population, la répartition suit le nombre de sommets */
+    double total = 0.0, sommets = 0.0;
+    for (int r = 0; r < nb_regions; r++) {
+        total += pop[r];
+        sommets += taille[r];
+    }
+
+    SommetTrie *restes = malloc(nb_regions * sizeof(SommetTrie));
+    int attribues = 0;
+    for (int r = 0; r < nb_regions; r++) {
+        double quota = total > 0.0 ? k * pop[r] / total : k * taille[r] / sommets;
+        budget[r] = (int)quota < taille[r] ? (int)quota : taille[r];
+        restes[r].cle = -(quota - (int)quota); // Tri croissant : plus grands restes d'abord
+        restes[r].id = r;
+        attribues += budget[r];
+    }
+    qsort(restes, nb_regions, sizeof(SommetTrie), comparer_sommets_tries);
+
+    /* Les stations restantes vont aux plus grands restes, puis à tour de rôle */
+    bool place = true;
+    while (attribues < k && place) {
+        place = false;
+        for (int i = 0; i < nb_regions && attribues < k; i++) {
+            int r = restes[i].id;
+            if (budget[r] < taille[r]) {
+                budget[r]++;
+                attribues++;
+                place = true;
+            }
+        }
+    }
+    free(restes);
+}
+
+// ---- RÉSOLUTION PAR RÉGION ----
+
+void resoudre_region(TravailRegions *t, int r) {
+    int nb = t->debut[r+1] - t->debut[r];
+    int *sommets = &t->sommets[t->debut[r]];
+    int k = t->budget[r];
+    if (k == 0 || nb == 0) return;
+
+    /* Sous-graphe induit au format CSR */
+    Csr c;
+    c.n = nb;
+    c.debut = calloc(nb + 1, sizeof(int));
+    for (int i = 0; i < nb; i++) {
+        int v = sommets[i];
+        c.debut[i+1] = c.debut[i];
+        for (int e = t->csr->debut[v]; e < t->csr->debut[v+1]; e++) {
+            if (t->region[t->csr->voisins[e]] == r) c.debut[i+1]++;
+        }
+    }
+    c.voisins = malloc((c.debut[nb] > 0 ? c.debut[nb] : 1) * sizeof(int));
+    c.poids = malloc((c.debut[nb] > 0 ? c.debut[nb] : 1) * sizeof(double));
+    double penalite = 1.0;
+    for (int i = 0, p = 0; i < nb; i++) {
+        int v = sommets[i];
+        for (int e = t->csr->debut[v]; e < t->csr->debut[v+1]; e++) {
+            int w = t->csr->voisins[e];
+            if (t->region[w] != r) continue;
+            c.voisins[p] = t->local[w];
+            c.poids[p++] = t->csr->poids[e];
+            if (isfinite(t->csr->poids[e])) penalite += t->csr->poids[e];
+        }
+    }
+
+    /* Le découpage peut isoler des morceaux de route : une distance infinie
+     * est remplacée par une pénalité supérieure à tout chemin de la région,
+     * ce qui garde cost() défini et pousse à couvrir chaque morceau. */
+    Distances D = distances_init(nb);
+    for (int s = 0; s < nb; s++) {
+        double *ligne = &D.d[(size_t)s * nb];
+        dijkstra(&c, &s, 1, ligne, NULL);
+        for (int v = 0; v < nb; v++) {
+            if (isinf(ligne[v])) ligne[v] = penalite;
+        }
+    }
+
+    int *centres = &t->centres[t->premier[r]];
+    kmedian_greedy(&D, k, centres);
+    local_search(&D, k, centres);
+    for (int i = 0; i < k; i++) {
+        centres[i] = sommets[centres[i]];
+    }
+
+    free_distances(&D);
+    free_csr(&c);
+}
+
+void *resoudre_regions(void *arg) {
+    TravailRegions *t = arg;
+    int r;
+    while ((r = __atomic_fetch_add(&t->suivant, 1, __ATOMIC_RELAXED)) < t->nb_regions) {
+        resoudre_region(t, r);
+    }
+    return NULL;
+}
+
+// ---- RÉPARATION AUX FRONTIÈRES ----
+
+typedef struct {
+    Csr *csr;
+    int k;
+    int *centres;
+    double *dist;
+    int *pred;
+    int *proprio; // Indice du centre le plus proche de chaque sommet (-1 si inaccessible)
+    int *debut_cellule; // Cellule du centre j : cellule[debut_cellule[j] ..]
+    int *cellule;
+    double *nouvelle; // Distances après un déplacement candidat (sommets touchés seulement)
+    bool *touche;
+    int *touches;
+} Reparation;
+
+/* Distances aux centres, propriétaires et cellules de Voronoï ; renvoie le
+ * coût global. */
+double voronoi(Reparation *rep) {
+    int n = rep->csr->n;
+    dijkstra(rep->csr, rep->centres, rep->k, rep->dist, rep->pred);
+
+    for (int v = 0; v < n; v++) rep->proprio[v] = isinf(rep->dist[v]) ? -1 : -2;
+    for (int j = 0; j < rep->k; j++) rep->proprio[rep->centres[j]] = j;
+    for (int v = 0; v < n; v++) {
+        int u = v;
+        while (rep->proprio[u] == -2) u = rep->pred[u];
+        int j = rep->proprio[u];
+        for (u = v; rep->proprio[u] == -2; u = rep->pred[u]) rep->proprio[u] = j;
+    }
+
+    memset(rep->debut_cellule, 0, (rep->k + 1) * sizeof(int));
+    for (int v = 0; v < n; v++) {
+        if (rep->proprio[v] >= 0) rep->debut_cellule[rep->proprio[v] + 1]++;
+    }
+    for (int j = 0; j < rep->k; j++) rep->debut_cellule[j+1] += rep->debut_cellule[j];
+    int *pos = malloc((rep->k > 0 ? rep->k : 1) * sizeof(int));
+    memcpy(pos, rep->debut_cellule, rep->k * sizeof(int));
+    double total = 0.0;
+    for (int v = 0; v < n; v++) {
+        total += rep->dist[v];
+        if (rep->proprio[v] >= 0) rep->cellule[pos[rep->proprio[v]]++] = v;
+    }
+    free(pos);
+    return total;
+}
+
+double valeur(Reparation *rep, int v, int j) {
+    if (rep->touche[v]) return rep->nouvelle[v];
+    return rep->proprio[v] == j ? INFINITY : rep->dist[v];
+}
+
+void toucher(Reparation *rep, int v, double d, int *nb_touches) {
+    if (!rep->touche[v]) {
+        rep->touche[v] = true;
+        rep->touches[(*nb_touches)++] = v;
+    }
+    rep->nouvelle[v] = d;
+}
+
+/* Variation exacte du coût global si le centre j est déplacé en u. */
+double gain_deplacement(Reparation *rep, int j, int u) {
+    Csr *c = rep->csr;
+    int nb_touches = 0;
+    Tas tas = tas_init(64);
+
+    /* Sommets de la cellule de j : repartent des sommets voisins hors cellule */
+    for (int i = rep->debut_cellule[j]; i < rep->debut_cellule[j+1]; i++) {
+        int x = rep->cellule[i];
+        for (int e = c->debut[x]; e < c->debut[x+1]; e++) {
+            int y = c->voisins[e];
+            if (rep->proprio[y] == j || rep->proprio[y] < 0) continue;
+            double d = rep->dist[y] + c->poids[e];
+            if (d < valeur(rep, x, j)) {
+                toucher(rep, x, d, &nb_touches);
+                tas_inserer(&tas, d, x);
+            }
+        }
+    }
+    if (0.0 < valeur(rep, u, j)) {
+        toucher(rep, u, 0.0, &nb_touches);
+        tas_inserer(&tas, 0.0, u);
+    }
+
+    while (!tas_vide(&tas)) {
+        ElementTas min = tas_extraire(&tas);
+        int x = min.val;
+        if (min.cle > valeur(rep, x, j)) continue; // Entrée obsolète
+        for (int e = c->debut[x]; e < c->debut[x+1]; e++) {
+            int y = c->voisins[e];
+            double d = min.cle + c->poids[e];
+            if (d < valeur(rep, y, j)) {
+                toucher(rep, y, d, &nb_touches);
+                tas_inserer(&tas, d, y);
+            }
+        }
+    }
+
+    double delta = 0.0;
+    for (int i = rep->debut_cellule[j]; i < rep->debut_cellule[j+1]; i++) {
+        if (!rep->touche[rep->cellule[i]]) delta = INFINITY; // Sommet désormais inaccessible
+    }
+    for (int i = 0; i < nb_touches; i++) {
+        int v = rep->touches[i];
+        if (!isinf(delta)) delta += rep->nouvelle[v] - rep->dist[v];
+        rep->touche[v] = false;
+    }
+    free_tas(&tas);
+    return delta;
+}
+
+/* Déplace vers un voisin les centres dont la cellule déborde de leur région,
+ * tant que le coût global diminue. Renvoie le coût final. */
+double reparer_frontieres(Csr *c, int *region, int k, int *centres, int *nb_deplacements) {
+    int n = c->n;
+    Reparation rep = {
+        c, k, centres,
+        malloc(n * sizeof(double)), malloc(n * sizeof(int)), malloc(n * sizeof(int)),
+        malloc((k + 1) * sizeof(int)), malloc(n * sizeof(int)),
+        malloc(n * sizeof(double)), calloc(n, sizeof(bool)), malloc(n * sizeof(int))
+    };
+    bool *est_centre = calloc(n, sizeof(bool));
+    for (int j = 0; j < k; j++) est_centre[centres[j]] = true;
+
+    *nb_deplacements = 0;
+    double total = voronoi(&rep);
+    for (int passe = 0; passe < PASSES_REPARATION; passe++) {
+        bool ameliore = false;
+        for (int j = 0; j < k; j++) {
+            bool frontiere = false;
+            for (int i = rep.debut_cellule[j]; i < rep.debut_cellule[j+1] && !frontiere; i++) {
+                frontiere = region[rep.cellule[i]] != region[centres[j]];
+            }
+            if (!frontiere) continue;
+
+            int meilleur = -1;
+            double meilleur_delta = -EPSILON_GAIN;
+            for (int e = c->debut[centres[j]]; e < c->debut[centres[j]+1]; e++) {
+                int u = c->voisins[e];
+                if (est_centre[u]) continue;
+                double delta = gain_deplacement(&rep, j, u);
+                if (delta < meilleur_delta) {
+                    meilleur_delta = delta;
+                    meilleur = u;
+                }
+            }
+            if (meilleur < 0) continue;
+
+            est_centre[centres[j]] = false;
+            centres[j] = meilleur;
+            est_centre[meilleur] = true;
+            total = voronoi(&rep);
+            (*nb_deplacements)++;
+            ameliore = true;
+        }
+        if (!ameliore) break;
+    }
+
+    free(rep.dist);
+    free(rep.pred);
+    free(rep.proprio);
+    free(rep.debut_cellule);
+    free(rep.cellule);
+    free(rep.nouvelle);
+    free(rep.touche);
+    free(rep.touches);
+    free(est_centre);
+    return total;
+}
+
+// ---- K-MÉDIAN PAR RÉGIONS ----
+
+/**
+ * k-médian approché par décomposition en nb_regions régions résolues en
+ * parallèle. centres (taille k) reçoit les centres, marqués comme stations.
+ * Renvoie le coût global (somme des distances au centre le plus proche).
+ */
+double kmedian_regions(Graph *g, int k, int nb_regions, int *centres) {
+    int n = vertices_count(g);
+    if (k > n) k = n;
+    if (nb_regions > n) nb_regions = n;
+    if (nb_regions < 1) nb_regions = 1;
+    if (!has_vertix_attribute(g, ATTR_LONG) || !has_vertix_attribute(g, ATTR_LAT)) {
+        fprintf(stderr, "Erreur : k-médian par régions impossible sans coordonnées, k-médian global utilisé.\n");
+        kmedian(g, k, centres);
+        Distances D = distances_charger(g, CACHE_DISTANCES, FORMAT_CACHE);
+        double total = cost(&D, centres, k);
+        free_distances(&D);
+        return total;
+    }
+
+    printf("\nK-MÉDIAN PAR RÉGIONS (%d sommets, k=%d, %d régions)\n\n", n, k, nb_regions);
+    double t0 = secondes();
+
+    double *pop = malloc(n * sizeof(double));
+    for (int v = 0; v < n; v++) {
+        pop[v] = get_vertix_attribute(g, v, ATTR_POP);
+    }
+
+    /* Découpage et regroupement des sommets par région */
+    int *region = malloc(n * sizeof(int));
+    int *ids = malloc(n * sizeof(int));
+    decouper_regions(g, nb_regions, region);
+
+    int *debut = calloc(nb_regions + 1, sizeof(int));
+    int *taille = calloc(nb_regions, sizeof(int));
+    double *pop_region = calloc(nb_regions, sizeof(double));
+    for (int v = 0; v < n; v++) {
+        taille[region[v]]++;
+        pop_region[region[v]] += pop[v];
+    }
+    for (int r = 0; r < nb_regions; r++) debut[r+1] = debut[r] + taille[r];
+    int *local = malloc(n * sizeof(int));
+    int *pos = malloc(nb_regions * sizeof(int));
+    memcpy(pos, debut, nb_regions * sizeof(int));
+    for (int v = 0; v < n; v++) {
+        local[v] = pos[region[v]] - debut[region[v]];
+        ids[pos[region[v]]++] = v;
+    }
+    free(pos);
+
+    int *budget = malloc(nb_regions * sizeof(int));
+    int *premier = calloc(nb_regions + 1, sizeof(int));
+    repartir_budget(k, pop_region, taille, nb_regions, budget);
+    for (int r = 0; r < nb_regions; r++) premier[r+1] = premier[r] + budget[r];
+    k = premier[nb_regions];
+
+    /* Résolution parallèle des régions */
+    Csr c = csr_from_graph(g);
+    TravailRegions t = { &c, region, local, debut, ids, budget, centres, premier, nb_regions, 0 };
+    bool bavard = kmedian_bavard;
+    kmedian_bavard = false;
+    int nb_threads = nb_coeurs() < nb_regions ? nb_coeurs() : nb_regions;
+    pthread_t *threads = malloc(nb_threads * sizeof(pthread_t));
+    for (int i = 0; i < nb_threads; i++) {
+        pthread_create(&threads[i], NULL, resoudre_regions, &t);
+    }
+    for (int i = 0; i < nb_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    double t1 = secondes();
+
+    for (int r = 0; r < nb_regions; r++) {
+        printf("Région %d : %d sommets, population %.0f, %d stations\n", r, taille[r], pop_region[r], budget[r]);
+    }
+
+    /* Réparation aux frontières sur le graphe entier */
+    double *dist = malloc(n * sizeof(double));
+    dijkstra(&c, centres, k, dist, NULL);
+    double cout_regions = 0.0;
+    int non_desservis = 0;
+    for (int v = 0; v < n; v++) {
+        cout_regions += dist[v];
+        if (isinf(dist[v])) non_desservis++;
+    }
+    free(dist);
+    if (non_desservis > 0) {
+        fprintf(stderr, "Erreur : %d sommets sans chemin vers une station (graphe non connexe).\n", non_desservis);
+    }
+    int nb_deplacements;
+    double cout_final = reparer_frontieres(&c, region, k, centres, &nb_deplacements);
+    double t2 = secondes();
+
+    printf("Coût après résolution par régions : %f (%.3f s)\n", cout_regions, t1 - t0);
+    printf("Coût après réparation des frontières : %f (%d déplacements, %.3f s)\n", cout_final, nb_deplacements, t2 - t1);
+
+    /* Pénalité par rapport au k-médian global, si la matrice est abordable */
+    if (n <= SEUIL_MONOLITHIQUE) {
+        Distances D = distances_charger(g, CACHE_DISTANCES, FORMAT_CACHE);
+        int *global = malloc((k > 0 ? k : 1) * sizeof(int));
+        double t3 = secondes();
+        kmedian_greedy(&D, k, global);
+        local_search(&D, k, global);
+        double cout_global = cost(&D, global, k);
+        printf("Coût du k-médian global : %f (%.3f s) / pénalité : %.2f %%\n", cout_global, secondes() - t3,
+               cout_global > 0.0 ? 100.0 * (cout_final - cout_global) / cout_global : 0.0);
+        free(global);
+        free_distances(&D);
+    }
+    kmedian_bavard = bavard;
+
+    for (int i = 0; i < k; i++) {
+        set_vertix_attribute(g, centres[i], ATTR_STATION, CHARGEUR);
+    }
+
+    free_csr(&c);
+    free(pop);
+    free(region);
+    free(ids);
+    free(local);
+    free(debut);
+    free(taille);
+    free(pop_region);
+    free(budget);
+    free(premier);
+    return cout_final;
+}
@@ -0,0 +1,1144 @@
+#include "tipe.h"
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ * Exécution répartie sur plusieurs processus. Le graphe est découpé en régions
+ * (decouper_regions) et chaque région est confiée à un processus travailleur
+ * qui ne connaît que son fragment : ses sommets, les arêtes internes, les
+ * arêtes qui sortent de la région (vers des sommets « fantômes » possédés par
+ * un autre processus), ses distances et ses véhicules.
+ *
+ * Un processus pilote relie les travailleurs par des sockets Unix et route les
+ * messages en rondes synchrones :
+ * - distances : chaque colonne (ensemble de sources) est calculée par des
+ *   Dijkstra locaux ; les distances qui franchissent une frontière sont
+ *   envoyées au propriétaire du sommet d'arrivée, qui reprend son Dijkstra à
+ *   partir de ces nouvelles bornes, jusqu'à ce qu'aucune ne baisse plus ;
+ * - simulation : à chaque tour, chaque travailleur avance ses véhicules d'une
+ *   arête et rend au pilote ceux qui passent dans une autre région.
+ *
+ * Les travailleurs ne reçoivent leur fragment que par message : rien ne les
+ * oblige à tourner sur la même machine que le pilote, ni à tenir en mémoire
+ * autre chose que leur part des distances.
+ */
+
+enum {
+    MESSAGE_FRAGMENT, // Pilote → travailleur : description du fragment
+    MESSAGE_COLONNES, // Pilote → travailleur : sources de chaque colonne de distances
+    MESSAGE_FRONTIERE, // Dans les deux sens : nouvelles bornes de distance aux frontières
+    MESSAGE_DEMANDE_LIGNES, // Pilote → travailleur : demande des distances des sommets frontières
+    MESSAGE_LIGNES, // Dans les deux sens : distances des sommets frontières (fantômes du voisin)
+    MESSAGE_SCORES, // Scores partiels de chaque colonne
+    MESSAGE_STATIONS, // Pilote → travailleur : stations du réseau
+    MESSAGE_TOUR, // Véhicules entrants et numéro du tour (pilote → travailleur) ou sortants (travailleur → pilote)
+    MESSAGE_BILAN, // Statistiques de simulation du travailleur
+    MESSAGE_FIN
+};
+
+typedef struct {
+    int type;
+    int nb; // Paramètre entier du message (nombre de colonnes, de véhicules terminés...)
+    size_t taille; // Taille des données qui suivent
+} EnteteMessage;
+
+typedef struct {
+    int shard, nb_shards;
+    int n, nb_arcs, nb_arcs_frontiere, nb_fantomes;
+} EnteteFragment;
+
+typedef struct { // Nouvelle borne de la distance d'un sommet à une colonne
+    int colonne;
+    int sommet; // Numéro global
+    double d;
+} MajDistance;
+
+typedef struct { // Suivie de nb_colonnes distances
+    int shard; // Destinataire
+    int sommet; // Numéro global
+} EnteteLigne;
+
+typedef struct {
+    double somme, pire, pop_totale, pop_couverte;
+} ScorePartiel;
+
+typedef struct {
+    int id;
+    int position, destination; // Numéros globaux
+    int cible; // Destination ou prochaine station (-1 : itinéraire à choisir)
+    float batterie, distance;
+    long entree; // Tour d'entrée sur le réseau
+    long attente; // Tours passés à attendre de pouvoir partir
+    int nb_arrets;
+    int arrets[MAX_ARRETS_REPARTIS]; // Stations déjà choisies comme étape
+} VehiculeReparti;
+
+typedef struct {
+    long trajets, arrives, pannes, autres;
+    double distance;
+    long duree_totale, duree_max, attente_totale;
+} BilanReparti;
+
+typedef struct {
+    char *donnees;
+    size_t taille, capacite;
+} Tampon;
+
+// ---- MESSAGES ----
+
+void tampon_ajouter(Tampon *t, const void *x, size_t taille) {
+    if (t->taille + taille > t->capacite) {
+        size_t capacite = t->capacite > 0 ? 2 * t->capacite : 4096;
+        while (capacite < t->taille + taille) capacite *= 2;
+        t->donnees = realloc(t->donnees, capacite);
+        if (t->donnees == NULL) {
+            fprintf(stderr, "Erreur : impossible d'agrandir un message.\n");
+            exit(EXIT_FAILURE);
+        }
+        t->capacite = capacite;
+    }
+    if (taille > 0) memcpy(t->donnees + t->taille, x, taille);
+    t->taille += taille;
+}
+
+/* Copie les taille octets suivants du message dans un tableau alloué. */
+void *extraire(const char **curseur, size_t taille) {
+    void *x = malloc(taille > 0 ? taille : 1);
+    if (x == NULL) {
+        fprintf(stderr, "Erreur : impossible d'allouer un fragment.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(x, *curseur, taille);
+    *curseur += taille;
+    return x;
+}
+
+void ecrire_tout(int canal, const void *donnees, size_t taille) {
+    const char *p = donnees;
+    while (taille > 0) {
+        ssize_t k = send(canal, p, taille, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) {
+            fprintf(stderr, "Erreur : échec d'envoi d'un message (%s).\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        p += k;
+        taille -= k;
+    }
+}
+
+/* Renvoie false si le canal est fermé avant d'avoir tout lu. */
+bool lire_tout(int canal, void *donnees, size_t taille) {
+    char *p = donnees;
+    while (taille > 0) {
+        ssize_t k = recv(canal, p, taille, 0);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false;
+        p += k;
+        taille -= k;
+    }
+    return true;
+}
+
+void envoyer(int canal, int type, int nb, const void *donnees, size_t taille) {
+    EnteteMessage e = { type, nb, taille };
+    ecrire_tout(canal, &e, sizeof(e));
+    ecrire_tout(canal, donnees, taille);
+}
+
+/* Renvoie les données du message suivant (à libérer), NULL si le canal est fermé. */
+char *recevoir(int canal, EnteteMessage *e) {
+    if (!lire_tout(canal, e, sizeof(EnteteMessage))) return NULL;
+    char *donnees = malloc(e->taille > 0 ? e->taille : 1);
+    if (donnees == NULL || !lire_tout(canal, donnees, e->taille)) {
+        free(donnees);
+        return NULL;
+    }
+    return donnees;
+}
+
+// ---- TRAVAILLEUR ----
+
+typedef struct {
+    int shard;
+    int n; // Sommets de la région
+    int *globaux; // Numéro global de chaque sommet local (croissants)
+    double *pop;
+    Csr csr; // Arêtes internes, en indices locaux
+    int *debut_frontiere; // Arcs vers les fantômes : [debut_frontiere[u], debut_frontiere[u+1])
+    int *fantome; // Indice du fantôme d'arrivée
+    double *poids_frontiere;
+    int nb_fantomes;
+    int *fantomes; // Numéros globaux des fantômes (croissants)
+    int *proprietaire; // Processus propriétaire de chaque fantôme
+
+    int nb_colonnes;
+    double *dist; // Colonne c : dist[c·n .. c·n + n)
+    double *envoye; // Meilleure borne déjà envoyée pour chaque (colonne, fantôme)
+    double *lignes; // Distances exactes des fantômes : lignes[c·nb_fantomes + g]
+    Tas tas;
+    long *sales; // Couples (colonne, sommet) dont la distance vient de baisser : c·n + u
+    int nb_sales, capacite_sales;
+
+    bool *est_station;
+    int *stations; // Numéros globaux
+    int nb_stations;
+    VehiculeReparti *flotte;
+    int nb_flotte, capacite_flotte;
+    BilanReparti bilan;
+} Fragment;
+
+int chercher(int *tableau, int nb, int x) {
+    int bas = 0, haut = nb - 1;
+    while (bas <= haut) {
+        int milieu = (bas + haut) / 2;
+        if (tableau[milieu] == x) return milieu;
+        if (tableau[milieu] < x) bas = milieu + 1;
+        else haut = milieu - 1;
+    }
+    return -1;
+}
+
+void recevoir_fragment(Fragment *f, const char *donnees) {
+    const char *curseur = donnees;
+    EnteteFragment ef;
+    memcpy(&ef, curseur, sizeof(ef));
+    curseur += sizeof(ef);
+
+    f->shard = ef.shard;
+    f->n = ef.n;
+    f->globaux = extraire(&curseur, ef.n * sizeof(int));
+    f->pop = extraire(&curseur, ef.n * sizeof(double));
+    f->csr.n = ef.n;
+    f->csr.debut = extraire(&curseur, (ef.n + 1) * sizeof(int));
+    f->csr.voisins = extraire(&curseur, ef.nb_arcs * sizeof(int));
+    f->csr.poids = extraire(&curseur, ef.nb_arcs * sizeof(double));
+    f->debut_frontiere = extraire(&curseur, (ef.n + 1) * sizeof(int));
+    f->fantome = extraire(&curseur, ef.nb_arcs_frontiere * sizeof(int));
+    f->poids_frontiere = extraire(&curseur, ef.nb_arcs_frontiere * sizeof(double));
+    f->nb_fantomes = ef.nb_fantomes;
+    f->fantomes = extraire(&curseur, ef.nb_fantomes * sizeof(int));
+    f->proprietaire = extraire(&curseur, ef.nb_fantomes * sizeof(int));
+    f->tas = tas_init(ef.n);
+    f->est_station = calloc(ef.n > 0 ? ef.n : 1, sizeof(bool));
+}
+
+void salir(Fragment *f, int c, int u) {
+    if (f->nb_sales == f->capacite_sales) {
+        f->capacite_sales = f->capacite_sales > 0 ? 2 * f->capacite_sales : 1024;
+        f->sales = realloc(f->sales, f->capacite_sales * sizeof(long));
+        if (f->sales == NULL) {
+            fprintf(stderr, "Erreur : impossible d'agrandir la liste des sommets à relâcher.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    f->sales[f->nb_sales++] = (long)c * f->n + u;
+}
+
+int comparer_longs(const void *x, const void *y) {
+    long a = *(const long *)x, b = *(const long *)y;
+    return (a > b) - (a < b);
+}
+
+/* Dijkstra de chaque colonne à partir des sommets dont la distance vient de
+ * baisser. Les bornes qui améliorent celles déjà envoyées à un fantôme partent
+ * dans sortie. */
+void relacher(Fragment *f, Tampon *sortie) {
+    qsort(f->sales, f->nb_sales, sizeof(long), comparer_longs);
+    int i = 0;
+    while (i < f->nb_sales) {
+        int c = (int)(f->sales[i] / f->n);
+        double *d = f->dist + (long)c * f->n;
+        double *envoye = f->envoye + (long)c * f->nb_fantomes;
+        for (; i < f->nb_sales && f->sales[i] / f->n == c; i++) {
+            if (i > 0 && f->sales[i] == f->sales[i-1]) continue;
+            int u = (int)(f->sales[i] % f->n);
+            tas_inserer(&f->tas, d[u], u);
+        }
+
+        while (!tas_vide(&f->tas)) {
+            ElementTas min = tas_extraire(&f->tas);
+            int u = min.val;
+            if (min.cle > d[u]) continue; // Entrée obsolète
+            for (int e = f->csr.debut[u]; e < f->csr.debut[u+1]; e++) {
+                int v = f->csr.voisins[e];
+                double nd = min.cle + f->csr.poids[e];
+                if (nd < d[v]) {
+                    d[v] = nd;
+                    tas_inserer(&f->tas, nd, v);
+                }
+            }
+            for (int e = f->debut_frontiere[u]; e < f->debut_frontiere[u+1]; e++) {
+                int g = f->fantome[e];
+                double nd = min.cle + f->poids_frontiere[e];
+                if (nd < envoye[g]) {
+                    envoye[g] = nd;
+                    MajDistance m = { c, f->fantomes[g], nd };
+                    tampon_ajouter(sortie, &m, sizeof(m));
+                }
+            }
+        }
+    }
+    f->nb_sales = 0;
+}
+
+void recevoir_colonnes(Fragment *f, int nb_colonnes, const char *donnees, Tampon *sortie) {
+    const int *debut = (const int *)donnees;
+    const int *sommets = debut + nb_colonnes + 1;
+
+    free(f->dist);
+    free(f->envoye);
+    free(f->lignes);
+    f->lignes = NULL;
+    f->nb_colonnes = nb_colonnes;
+    f->dist = malloc(((size_t)nb_colonnes * f->n + 1) * sizeof(double));
+    f->envoye = malloc(((size_t)nb_colonnes * f->nb_fantomes + 1) * sizeof(double));
+    if (f->dist == NULL || f->envoye == NULL) {
+        fprintf(stderr, "Erreur : impossible d'allouer les distances du processus %d.\n", f->shard);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < (size_t)nb_colonnes * f->n; i++) f->dist[i] = INFINITY;
+    for (size_t i = 0; i < (size_t)nb_colonnes * f->nb_fantomes; i++) f->envoye[i] = INFINITY;
+
+    for (int c = 0; c < nb_colonnes; c++) {
+        for (int i = debut[c]; i < debut[c+1]; i++) {
+            int u = chercher(f->globaux, f->n, sommets[i]);
+            if (u >= 0 && f->dist[(long)c * f->n + u] > 0.0) {
+                f->dist[(long)c * f->n + u] = 0.0;
+                salir(f, c, u);
+            }
+        }
+    }
+    relacher(f, sortie);
+}
+
+void recevoir_frontiere(Fragment *f, const char *donnees, size_t taille, Tampon *sortie) {
+    int nb = taille / sizeof(MajDistance);
+    const MajDistance *majs = (const MajDistance *)donnees;
+    for (int i = 0; i < nb; i++) {
+        int u = chercher(f->globaux, f->n, majs[i].sommet);
+        if (u < 0) continue;
+        double *d = &f->dist[(long)majs[i].colonne * f->n + u];
+        if (majs[i].d < *d) {
+            *d = majs[i].d;
+            salir(f, majs[i].colonne, u);
+        }
+    }
+    relacher(f, sortie);
+}
+
+/* Distances des sommets frontières, une fois par processus voisin. */
+void envoyer_lignes(Fragment *f, Tampon *sortie) {
+    for (int u = 0; u < f->n; u++) {
+        for (int e = f->debut_frontiere[u]; e < f->debut_frontiere[u+1]; e++) {
+            int shard = f->proprietaire[f->fantome[e]];
+            bool deja = false;
+            for (int e2 = f->debut_frontiere[u]; e2 < e && !deja; e2++) {
+                deja = f->proprietaire[f->fantome[e2]] == shard;
+            }
+            if (deja) continue;
+            EnteteLigne l = { shard, f->globaux[u] };
+            tampon_ajouter(sortie, &l, sizeof(l));
+            for (int c = 0; c < f->nb_colonnes; c++) {
+                tampon_ajouter(sortie, &f->dist[(long)c * f->n + u], sizeof(double));
+            }
+        }
+    }
+}
+
+void recevoir_lignes(Fragment *f, const char *donnees, size_t taille) {
+    free(f->lignes);
+    f->lignes = malloc(((size_t)f->nb_colonnes * f->nb_fantomes + 1) * sizeof(double));
+    if (f->lignes == NULL) {
+        fprintf(stderr, "Erreur : impossible d'allouer les distances des fantômes.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < (size_t)f->nb_colonnes * f->nb_fantomes; i++) f->lignes[i] = INFINITY;
+
+    size_t taille_ligne = sizeof(EnteteLigne) + f->nb_colonnes * sizeof(double);
+    for (size_t p = 0; p + taille_ligne <= taille; p += taille_ligne) {
+        EnteteLigne l;
+        memcpy(&l, donnees + p, sizeof(l));
+        int g = chercher(f->fantomes, f->nb_fantomes, l.sommet);
+        if (g < 0) continue;
+        for (int c = 0; c < f->nb_colonnes; c++) {
+            memcpy(&f->lignes[(long)c * f->nb_fantomes + g], donnees + p + sizeof(l) + c * sizeof(double), sizeof(double));
+        }
+    }
+}
+
+void noter_colonnes(Fragment *f, Tampon *sortie) {
+    for (int c = 0; c < f->nb_colonnes; c++) {
+        ScorePartiel s = { 0.0, 0.0, 0.0, 0.0 };
+        double *d = f->dist + (long)c * f->n;
+        for (int u = 0; u < f->n; u++) {
+            s.somme += d[u];
+            if (d[u] > s.pire) s.pire = d[u];
+            s.pop_totale += f->pop[u];
+            if (d[u] <= RAYON_COUVERTURE) s.pop_couverte += f->pop[u];
+        }
+        tampon_ajouter(sortie, &s, sizeof(s));
+    }
+}
+
+// ---- VÉHICULES ----
+
+/* Les colonnes de la simulation sont les sommets : distance(x, c) est la
+ * distance du sommet local x au sommet global c. */
+double distance_locale(Fragment *f, int u, int c) {
+    return f->dist[(long)c * f->n + u];
+}
+
+/* Trajet terminé au tour fin : comme dans simulation_flux(), la durée compte
+ * les tours passés sur le réseau, de l'entrée à fin inclus (0 pour un trajet
+ * terminé dès son injection). */
+void terminer(Fragment *f, VehiculeReparti *v, Statut statut, long fin) {
+    BilanReparti *b = &f->bilan;
+    long duree = fin + 1 - v->entree;
+    b->trajets++;
+    b->distance += v->distance;
+    b->duree_totale += duree;
+    b->attente_totale += v->attente;
+    if (duree > b->duree_max) b->duree_max = duree;
+    if (statut == ARRIVE) b->arrives++;
+    else if (statut == EN_PANNE) b->pannes++;
+    else b->autres++;
+}
+
+/* Même stratégie que router_trajet() : la destination si elle est à portée,
+ * sinon la station non encore utilisée la plus lointaine parmi celles à
+ * portée (hors de la station où il se trouve, où il vient de recharger).
+ * Renvoie false si aucune n'est atteignable. */
+bool choisir_cible(Fragment *f, VehiculeReparti *v, int u) {
+    double reste = distance_locale(f, u, v->destination);
+    if (isinf(reste)) return false;
+    if (reste * CONSOMMATION <= v->batterie) {
+        v->cible = v->destination;
+        return true;
+    }
+    if (v->nb_arrets == MAX_ARRETS_REPARTIS) return false;
+
+    int meilleure = -1;
+    double plus_loin = -1.0;
+    for (int i = 0; i < f->nb_stations; i++) {
+        int s = f->stations[i];
+        double d = distance_locale(f, u, s);
+        if (s == v->position || d * CONSOMMATION > v->batterie || d <= plus_loin) continue;
+        bool utilisee = false;
+        for (int a = 0; a < v->nb_arrets && !utilisee; a++) {
+            utilisee = v->arrets[a] == s;
+        }
+        if (!utilisee) {
+            plus_loin = d;
+            meilleure = s;
+        }
+    }
+    if (meilleure == -1) return false;
+    v->arrets[v->nb_arrets++] = meilleure;
+    v->cible = meilleure;
+    return true;
+}
+
+/* Arrivée d'un véhicule sur le sommet local u, atteint au tour fin. Renvoie
+ * false s'il a terminé. */
+bool arriver(Fragment *f, VehiculeReparti *v, int u, long fin) {
+    if (v->position == v->destination) {
+        terminer(f, v, ARRIVE, fin);
+        return false;
+    }
+    if (f->est_station[u]) v->batterie = CAPACITE_BATTERIE; // Recharge instantanée, sans bornes (comme simulation_flux())
+    if ((v->cible == -1 || v->position == v->cible) && !choisir_cible(f, v, u)) {
+        /* Comme dans simulation_flux(), un véhicule bloqué en route ne le
+         * constate qu'au tour suivant ; bloqué au départ, il n'entre pas */
+        terminer(f, v, AUTRE, v->entree > fin ? fin : fin + 1);
+        return false;
+    }
+    return true;
+}
+
+/* Avance un véhicule d'une arête vers sa cible au tour donné, comme
+ * avancer_vehicule(). Renvoie 0 s'il reste dans la région, 1 s'il a terminé,
+ * 2 s'il la quitte. */
+int avancer(Fragment *f, VehiculeReparti *v, long tour) {
+    int u = chercher(f->globaux, f->n, v->position);
+    int suivant = -1;
+    bool fantome = false;
+    double meilleur = INFINITY, poids = 0.0;
+    for (int e = f->csr.debut[u]; e < f->csr.debut[u+1]; e++) {
+        double via = f->csr.poids[e] + distance_locale(f, f->csr.voisins[e], v->cible);
+        if (via < meilleur) {
+            meilleur = via;
+            suivant = f->csr.voisins[e];
+            poids = f->csr.poids[e];
+        }
+    }
+    for (int e = f->debut_frontiere[u]; e < f->debut_frontiere[u+1]; e++) {
+        int g = f->fantome[e];
+        double via = f->poids_frontiere[e] + f->lignes[(long)v->cible * f->nb_fantomes + g];
+        if (via < meilleur) {
+            meilleur = via;
+            suivant = g;
+            poids = f->poids_frontiere[e];
+            fantome = true;
+        }
+    }
+    if (suivant == -1) {
+        terminer(f, v, AUTRE, tour);
+        return 1;
+    }
+
+    double conso = poids * CONSOMMATION;
+    if (conso > v->batterie + 1e-9) {
+        terminer(f, v, EN_PANNE, tour);
+        return 1;
+    }
+    v->batterie -= conso;
+    v->distance += poids;
+
+    if (fantome) {
+        v->position = f->fantomes[suivant];
+        return 2;
+    }
+    v->position = f->globaux[suivant];
+    return arriver(f, v, suivant, tour) ? 0 : 1;
+}
+
+/* Un tour de simulation : accueille les véhicules entrants (nouveaux ou venus
+ * d'une autre région au tour précédent), puis avance chaque véhicule d'une
+ * arête. Les véhicules qui quittent la région partent dans sortie ; renvoie le
+ * nombre de véhicules terminés. Un entrant qui termine à l'accueil a terminé
+ * au tour précédent (sa durée est nulle s'il vient d'être injecté). */
+int simuler_tour_fragment(Fragment *f, long tour, const char *donnees, size_t taille, Tampon *sortie) {
+    int termines = 0;
+    int nb = taille / sizeof(VehiculeReparti);
+    for (int i = 0; i < nb; i++) {
+        VehiculeReparti v;
+        memcpy(&v, donnees + i * sizeof(VehiculeReparti), sizeof(v));
+        if (!arriver(f, &v, chercher(f->globaux, f->n, v.position), tour - 1)) {
+            termines++;
+            continue;
+        }
+        if (f->nb_flotte == f->capacite_flotte) {
+            f->capacite_flotte = f->capacite_flotte > 0 ? 2 * f->capacite_flotte : 256;
+            f->flotte = realloc(f->flotte, f->capacite_flotte * sizeof(VehiculeReparti));
+            if (f->flotte == NULL) {
+                fprintf(stderr, "Erreur : impossible d'agrandir la flotte du processus %d.\n", f->shard);
+                exit(EXIT_FAILURE);
+            }
+        }
+        f->flotte[f->nb_flotte++] = v;
+    }
+
+    for (int i = 0; i < f->nb_flotte; i++) {
+        VehiculeReparti *v = &f->flotte[i];
+        int issue = avancer(f, v, tour);
+        if (issue == 0) continue;
+        if (issue == 1) {
+            termines++;
+        } else {
+            tampon_ajouter(sortie, v, sizeof(VehiculeReparti));
+        }
+        f->flotte[i--] = f->flotte[--f->nb_flotte];
+    }
+    return termines;
+}
+
+void free_fragment(Fragment *f) {
+    free(f->globaux);
+    free(f->pop);
+    free_csr(&f->csr);
+    free(f->debut_frontiere);
+    free(f->fantome);
+    free(f->poids_frontiere);
+    free(f->fantomes);
+    free(f->proprietaire);
+    free(f->dist);
+    free(f->envoye);
+    free(f->lignes);
+    free_tas(&f->tas);
+    free(f->sales);
+    free(f->est_station);
+    free(f->stations);
+    free(f->flotte);
+}
+
+/* Boucle d'un processus travailleur : répond aux messages du pilote jusqu'à
+ * MESSAGE_FIN (ou la fermeture du canal). */
+void travailleur(int canal) {
+    Fragment f;
+    memset(&f, 0, sizeof(f));
+    bool fini = false;
+    while (!fini) {
+        EnteteMessage e;
+        char *donnees = recevoir(canal, &e);
+        if (donnees == NULL) break;
+        Tampon sortie = { NULL, 0, 0 };
+
+        switch (e.type) {
+        case MESSAGE_FRAGMENT:
+            recevoir_fragment(&f, donnees);
+            break;
+
+        case MESSAGE_COLONNES:
+            recevoir_colonnes(&f, e.nb, donnees, &sortie);
+            envoyer(canal, MESSAGE_FRONTIERE, 0, sortie.donnees, sortie.taille);
+            break;
+
+        case MESSAGE_FRONTIERE:
+            recevoir_frontiere(&f, donnees, e.taille, &sortie);
+            envoyer(canal, MESSAGE_FRONTIERE, 0, sortie.donnees, sortie.taille);
+            break;
+
+        case MESSAGE_DEMANDE_LIGNES:
+            envoyer_lignes(&f, &sortie);
+            envoyer(canal, MESSAGE_LIGNES, 0, sortie.donnees, sortie.taille);
+            break;
+
+        case MESSAGE_LIGNES:
+            recevoir_lignes(&f, donnees, e.taille);
+            break;
+
+        case MESSAGE_SCORES:
+            noter_colonnes(&f, &sortie);
+            envoyer(canal, MESSAGE_SCORES, 0, sortie.donnees, sortie.taille);
+            break;
+
+        case MESSAGE_STATIONS:
+            f.nb_stations = e.taille / sizeof(int);
+            f.stations = malloc(e.taille > 0 ? e.taille : 1);
+            memcpy(f.stations, donnees, e.taille);
+            for (int i = 0; i < f.nb_stations; i++) {
+                int u = chercher(f.globaux, f.n, f.stations[i]);
+                if (u >= 0) f.est_station[u] = true;
+            }
+            break;
+
+        case MESSAGE_TOUR: {
+            int termines = simuler_tour_fragment(&f, e.nb, donnees, e.taille, &sortie);
+            envoyer(canal, MESSAGE_TOUR, termines, sortie.donnees, sortie.taille);
+            break;
+        }
+
+        case MESSAGE_BILAN:
+            envoyer(canal, MESSAGE_BILAN, 0, &f.bilan, sizeof(BilanReparti));
+            break;
+
+        default:
+            fini = true;
+            break;
+        }
+        free(sortie.donnees);
+        free(donnees);
+    }
+    free_fragment(&f);
+    close(canal);
+}
+
+// ---- PILOTE ----
+
+typedef struct {
+    int nb; // Nombre de processus travailleurs
+    int n;
+    int *region; // Processus propriétaire de chaque sommet
+    int *canaux;
+    pid_t *pids;
+    int *taille, *nb_fantomes; // Sommets et fantômes de chaque fragment
+    long messages, octets;
+    int rondes; // Rondes d'échange aux frontières du dernier calcul de distances
+} Grappe;
+
+void grappe_envoyer(Grappe *gr, int i, int type, int nb, const void *donnees, size_t taille) {
+    envoyer(gr->canaux[i], type, nb, donnees, taille);
+    gr->messages++;
+    gr->octets += sizeof(EnteteMessage) + taille;
+}
+
+char *grappe_recevoir(Grappe *gr, int i, int type, EnteteMessage *e) {
+    char *donnees = recevoir(gr->canaux[i], e);
+    if (donnees == NULL || e->type != type) {
+        fprintf(stderr, "Erreur : le processus %d ne répond plus.\n", i);
+        exit(EXIT_FAILURE);
+    }
+    gr->messages++;
+    gr->octets += sizeof(EnteteMessage) + e->taille;
+    return donnees;
+}
+
+int comparer_ints(const void *x, const void *y) {
+    int a = *(const int *)x, b = *(const int *)y;
+    return (a > b) - (a < b);
+}
+
+/* Construit et envoie le fragment du processus i. */
+void envoyer_fragment(Grappe *gr, Graph *g, Csr *c, int *local, int i) {
+    int n = 0, nb_arcs = 0, nb_arcs_frontiere = 0;
+    for (int v = 0; v < c->n; v++) {
+        if (gr->region[v] != i) continue;
+        n++;
+        for (int e = c->debut[v]; e < c->debut[v+1]; e++) {
+            if (gr->region[c->voisins[e]] == i) nb_arcs++;
+            else nb_arcs_frontiere++;
+        }
+    }
+
+    int *globaux = malloc((n + 1) * sizeof(int));
+    double *pop = malloc((n + 1) * sizeof(double));
+    int *debut = calloc(n + 1, sizeof(int));
+    int *voisins = malloc((nb_arcs + 1) * sizeof(int));
+    double *poids = malloc((nb_arcs + 1) * sizeof(double));
+    int *debut_frontiere = calloc(n + 1, sizeof(int));
+    int *fantome = malloc((nb_arcs_frontiere + 1) * sizeof(int));
+    double *poids_frontiere = malloc((nb_arcs_frontiere + 1) * sizeof(double));
+    int *fantomes = malloc((nb_arcs_frontiere + 1) * sizeof(int));
+    int *proprietaire = malloc((nb_arcs_frontiere + 1) * sizeof(int));
+
+    /* Fantômes : voisins distincts hors de la région, triés */
+    int nb_fantomes = 0;
+    for (int v = 0; v < c->n; v++) {
+        if (gr->region[v] != i) continue;
+        for (int e = c->debut[v]; e < c->debut[v+1]; e++) {
+            if (gr->region[c->voisins[e]] != i) fantomes[nb_fantomes++] = c->voisins[e];
+        }
+    }
+    qsort(fantomes, nb_fantomes, sizeof(int), comparer_ints);
+    int distincts = 0;
+    for (int j = 0; j < nb_fantomes; j++) {
+        if (distincts == 0 || fantomes[j] != fantomes[distincts-1]) fantomes[distincts++] = fantomes[j];
+    }
+    nb_fantomes = distincts;
+    for (int j = 0; j < nb_fantomes; j++) proprietaire[j] = gr->region[fantomes[j]];
+
+    int u = 0, a = 0, b = 0;
+    for (int v = 0; v < c->n; v++) {
+        if (gr->region[v] != i) continue;
+        globaux[u] = v;
+        pop[u] = get_vertix_attribute(g, v, ATTR_POP);
+        for (int e = c->debut[v]; e < c->debut[v+1]; e++) {
+            int w = c->voisins[e];
+            if (gr->region[w] == i) {
+                voisins[a] = local[w];
+                poids[a++] = c->poids[e];
+            } else {
+                fantome[b] = chercher(fantomes, nb_fantomes, w);
+                poids_frontiere[b++] = c->poids[e];
+            }
+        }
+        u++;
+        debut[u] = a;
+        debut_frontiere[u] = b;
+    }
+
+    EnteteFragment ef = { i, gr->nb, n, nb_arcs, nb_arcs_frontiere, nb_fantomes };
+    Tampon t = { NULL, 0, 0 };
+    tampon_ajouter(&t, &ef, sizeof(ef));
+    tampon_ajouter(&t, globaux, n * sizeof(int));
+    tampon_ajouter(&t, pop, n * sizeof(double));
+    tampon_ajouter(&t, debut, (n + 1) * sizeof(int));
+    tampon_ajouter(&t, voisins, nb_arcs * sizeof(int));
+    tampon_ajouter(&t, poids, nb_arcs * sizeof(double));
+    tampon_ajouter(&t, debut_frontiere, (n + 1) * sizeof(int));
+    tampon_ajouter(&t, fantome, nb_arcs_frontiere * sizeof(int));
+    tampon_ajouter(&t, poids_frontiere, nb_arcs_frontiere * sizeof(double));
+    tampon_ajouter(&t, fantomes, nb_fantomes * sizeof(int));
+    tampon_ajouter(&t, proprietaire, nb_fantomes * sizeof(int));
+    grappe_envoyer(gr, i, MESSAGE_FRAGMENT, 0, t.donnees, t.taille);
+    gr->taille[i] = n;
+    gr->nb_fantomes[i] = nb_fantomes;
+
+    free(t.donnees);
+    free(globaux);
+    free(pop);
+    free(debut);
+    free(voisins);
+    free(poids);
+    free(debut_frontiere);
+    free(fantome);
+    free(poids_frontiere);
+    free(fantomes);
+    free(proprietaire);
+}
+
+/* Découpe le graphe en nb régions et lance un processus travailleur par région. */
+Grappe grappe_lancer(Graph *g, int nb) {
+    Grappe gr;
+    memset(&gr, 0, sizeof(gr));
+    gr.n = vertices_count(g);
+    if (nb > gr.n) nb = gr.n;
+    if (nb < 1) nb = 1;
+    gr.nb = nb;
+    gr.region = malloc((gr.n + 1) * sizeof(int));
+    gr.canaux = malloc(nb * sizeof(int));
+    gr.pids = malloc(nb * sizeof(pid_t));
+    gr.taille = calloc(nb, sizeof(int));
+    gr.nb_fantomes = calloc(nb, sizeof(int));
+    decouper_regions(g, nb, gr.region);
+
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < nb; i++) {
+        int paire[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, paire) != 0) {
+            perror("Erreur de création d'un canal");
+            exit(EXIT_FAILURE);
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("Erreur de création d'un processus travailleur");
+            exit(EXIT_FAILURE);
+        }
+        if (pid == 0) {
+            close(paire[0]);
+            for (int j = 0; j < i; j++) close(gr.canaux[j]);
+            travailleur(paire[1]);
+            _exit(EXIT_SUCCESS);
+        }
+        close(paire[1]);
+        gr.canaux[i] = paire[0];
+        gr.pids[i] = pid;
+    }
+
+    Csr c = csr_from_graph(g);
+    int *local = malloc((gr.n + 1) * sizeof(int));
+    int *compte = calloc(nb, sizeof(int));
+    for (int v = 0; v < gr.n; v++) {
+        local[v] = compte[gr.region[v]]++;
+    }
+    for (int i = 0; i < nb; i++) {
+        envoyer_fragment(&gr, g, &c, local, i);
+    }
+    free(local);
+    free(compte);
+    free_csr(&c);
+    return gr;
+}
+
+void grappe_arreter(Grappe *gr) {
+    for (int i = 0; i < gr->nb; i++) {
+        grappe_envoyer(gr, i, MESSAGE_FIN, 0, NULL, 0);
+        close(gr->canaux[i]);
+    }
+    for (int i = 0; i < gr->nb; i++) {
+        int statut;
+        waitpid(gr->pids[i], &statut, 0);
+        if (!WIFEXITED(statut) || WEXITSTATUS(statut) != EXIT_SUCCESS) {
+            fprintf(stderr, "Erreur : le processus %d s'est arrêté anormalement.\n", i);
+        }
+    }
+    free(gr->region);
+    free(gr->canaux);
+    free(gr->pids);
+    free(gr->taille);
+    free(gr->nb_fantomes);
+}
+
+/**
+ * Calcule les distances de tous les sommets à nb_colonnes ensembles de
+ * sources (colonne c : sommets[debut[c] .. debut[c+1])). Chaque processus
+ * garde les distances de ses sommets ; le pilote route les bornes qui
+ * franchissent les frontières jusqu'à ce qu'aucune ne baisse plus.
+ */
+void grappe_distances(Grappe *gr, int nb_colonnes, int *debut, int *sommets) {
+    Tampon t = { NULL, 0, 0 };
+    tampon_ajouter(&t, debut, (nb_colonnes + 1) * sizeof(int));
+    tampon_ajouter(&t, sommets, debut[nb_colonnes] * sizeof(int));
+    for (int i = 0; i < gr->nb; i++) {
+        grappe_envoyer(gr, i, MESSAGE_COLONNES, nb_colonnes, t.donnees, t.taille);
+    }
+    free(t.donnees);
+
+    Tampon *entrants = calloc(gr->nb, sizeof(Tampon));
+    gr->rondes = 0;
+    while (true) {
+        long nb_majs = 0;
+        for (int i = 0; i < gr->nb; i++) {
+            EnteteMessage e;
+            char *donnees = grappe_recevoir(gr, i, MESSAGE_FRONTIERE, &e);
+            int nb = e.taille / sizeof(MajDistance);
+            for (int j = 0; j < nb; j++) {
+                MajDistance m;
+                memcpy(&m, donnees + j * sizeof(MajDistance), sizeof(m));
+                tampon_ajouter(&entrants[gr->region[m.sommet]], &m, sizeof(m));
+            }
+            nb_majs += nb;
+            free(donnees);
+        }
+        if (nb_majs == 0) break;
+
+        gr->rondes++;
+        for (int i = 0; i < gr->nb; i++) {
+            grappe_envoyer(gr, i, MESSAGE_FRONTIERE, 0, entrants[i].donnees, entrants[i].taille);
+            entrants[i].taille = 0;
+        }
+    }
+
+    for (int i = 0; i < gr->nb; i++) {
+        free(entrants[i].donnees);
+    }
+    free(entrants);
+}
+
+/* Donne à chaque processus les distances exactes de ses fantômes. */
+void grappe_echanger_lignes(Grappe *gr, int nb_colonnes) {
+    size_t taille_ligne = sizeof(EnteteLigne) + nb_colonnes * sizeof(double);
+    Tampon *entrants = calloc(gr->nb, sizeof(Tampon));
+    for (int i = 0; i < gr->nb; i++) {
+        grappe_envoyer(gr, i, MESSAGE_DEMANDE_LIGNES, 0, NULL, 0);
+    }
+    for (int i = 0; i < gr->nb; i++) {
+        EnteteMessage e;
+        char *donnees = grappe_recevoir(gr, i, MESSAGE_LIGNES, &e);
+        for (size_t p = 0; p + taille_ligne <= e.taille; p += taille_ligne) {
+            EnteteLigne l;
+            memcpy(&l, donnees + p, sizeof(l));
+            tampon_ajouter(&entrants[l.shard], donnees + p, taille_ligne);
+        }
+        free(donnees);
+    }
+    for (int i = 0; i < gr->nb; i++) {
+        grappe_envoyer(gr, i, MESSAGE_LIGNES, 0, entrants[i].donnees, entrants[i].taille);
+        free(entrants[i].donnees);
+    }
+    free(entrants);
+}
+
+void afficher_grappe(Grappe *gr) {
+    for (int i = 0; i < gr->nb; i++) {
+        printf("Processus %d (pid %d) : %d sommets, %d fantômes\n", i, (int)gr->pids[i], gr->taille[i], gr->nb_fantomes[i]);
+    }
+}
+
+// ---- ÉVALUATION RÉPARTIE ----
+
+/**
+ * Même notation que evaluer_placements(), mais chaque placement est une
+ * colonne de distances calculée par nb_processus processus, chacun sur sa
+ * région du graphe.
+ */
+void evaluer_placements_repartis(Graph *g, Placement *placements, int nb, Score *scores, int nb_processus) {
+    double t0 = secondes();
+    Grappe gr = grappe_lancer(g, nb_processus);
+
+    int *debut = malloc((nb + 1) * sizeof(int));
+    debut[0] = 0;
+    for (int i = 0; i < nb; i++) debut[i+1] = debut[i] + placements[i].nb;
+    int *sommets = malloc((debut[nb] + 1) * sizeof(int));
+    for (int i = 0; i < nb; i++) {
+        memcpy(sommets + debut[i], placements[i].sommets, placements[i].nb * sizeof(int));
+    }
+    grappe_distances(&gr, nb, debut, sommets);
+
+    ScorePartiel *total = calloc(nb > 0 ? nb : 1, sizeof(ScorePartiel));
+    for (int i = 0; i < gr.nb; i++) {
+        grappe_envoyer(&gr, i, MESSAGE_SCORES, 0, NULL, 0);
+    }
+    for (int i = 0; i < gr.nb; i++) {
+        EnteteMessage e;
+        char *donnees = grappe_recevoir(&gr, i, MESSAGE_SCORES, &e);
+        for (int c = 0; c < nb; c++) {
+            ScorePartiel s;
+            memcpy(&s, donnees + c * sizeof(ScorePartiel), sizeof(s));
+            total[c].somme += s.somme;
+            if (s.pire > total[c].pire) total[c].pire = s.pire;
+            total[c].pop_totale += s.pop_totale;
+            total[c].pop_couverte += s.pop_couverte;
+        }
+        free(donnees);
+    }
+    for (int c = 0; c < nb; c++) {
+        scores[c].cout = total[c].somme;
+        scores[c].pire = total[c].pire;
+        scores[c].couverture = total[c].pop_totale > 0.0 ? 100.0 * total[c].pop_couverte / total[c].pop_totale : 0.0;
+        if (placements[c].nb == 0) scores[c].cout = scores[c].pire = INFINITY;
+    }
+
+    printf("Évaluation répartie sur %d processus : %d rondes d'échange, %ld messages (%.2f Mo) en %.3f s\n",
+           gr.nb, gr.rondes, gr.messages, gr.octets / 1e6, secondes() - t0);
+    grappe_arreter(&gr);
+    free(debut);
+    free(sommets);
+    free(total);
+}
+
+// ---- SIMULATION RÉPARTIE ----
+
+typedef struct { // Trajets lus dans un fichier ou générés comme dans la simulation en flux
+    ParamFlux param;
+    FILE *fichier;
+    int n;
+    double *pop_cumulee;
+    double horloge;
+    long generes, invalides;
+    unsigned int graine;
+} SourceTrajets;
+
+bool trajet_suivant(SourceTrajets *s, int *depart, int *destination, long *tour) {
+    if (s->fichier != NULL) {
+        char line[MAX_LINE_LENGTH];
+        while (fgets(line, MAX_LINE_LENGTH, s->fichier)) {
+            if (line[0] == CSV_SKIP_LINE || line[0] == '\n') continue;
+            *tour = 0;
+            if (sscanf(line, "%d , %d , %ld", depart, destination, tour) < 2
+                || *depart < 0 || *depart >= s->n || *destination < 0 || *destination >= s->n) {
+                s->invalides++;
+                continue;
+            }
+            return true;
+        }
+        return false;
+    }
+    if (s->param.fichier != NULL || s->generes == s->param.nb_trajets) return false;
+
+    double u = ((double)rand_r(&s->graine) + 1.0) / ((double)RAND_MAX + 1.0);
+    s->horloge += -log(u) / s->param.taux;
+    *depart = tirer_pondere(s->pop_cumulee, s->n, &s->graine);
+    do {
+        *destination = rand_r(&s->graine) % s->n;
+    } while (*destination == *depart);
+    *tour = (long)s->horloge;
+    s->generes++;
+    return true;
+}
+
+/**
+ * Simulation en flux répartie sur nb_processus processus : chaque processus
+ * garde les distances de ses sommets à tous les autres et fait rouler les
+ * véhicules de sa région ; ceux qui franchissent une frontière passent au
+ * processus voisin par l'intermédiaire du pilote. Les trajets sont les mêmes
+ * que ceux de simulation_flux() pour les mêmes paramètres ; renvoie le bilan
+ * dans le même format.
+ */
+StatistiquesFlux simulation_repartie(Graph reseau, ParamFlux param, int nb_processus) {
+    printf("Simulation répartie\n");
+    int n = vertices_count(&reseau);
+    StatistiquesFlux total;
+    memset(&total, 0, sizeof(total));
+    if (param.taille_pool <= 0 || (param.fichier == NULL && param.taux <= 0.0)) {
+        fprintf(stderr, "Erreur : paramètres de simulation répartie invalides.\n");
+        return total;
+    }
+    if (n < 2) {
+        fprintf(stderr, "Erreur : le réseau doit contenir au moins deux sommets.\n");
+        return total;
+    }
+
+    double t0 = secondes();
+    Grappe gr = grappe_lancer(&reseau, nb_processus);
+    afficher_grappe(&gr);
+
+    /* Une colonne par sommet : distances de chaque sommet à tous les autres */
+    int *debut = malloc((n + 1) * sizeof(int));
+    int *sommets = malloc(n * sizeof(int));
+    for (int v = 0; v < n; v++) {
+        debut[v] = v;
+        sommets[v] = v;
+    }
+    debut[n] = n;
+    grappe_distances(&gr, n, debut, sommets);
+    grappe_echanger_lignes(&gr, n);
+    free(debut);
+    free(sommets);
+    printf("Distances réparties : %d rondes d'échange, %ld messages (%.2f Mo) en %.3f s\n",
+           gr.rondes, gr.messages, gr.octets / 1e6, secondes() - t0);
+
+    int *stations = malloc(n * sizeof(int));
+    int nb_stations = 0;
+    SourceTrajets source = { param, NULL, n, malloc(n * sizeof(double)), 0.0, 0, 0, param.graine };
+    double cumul = 0.0;
+    for (int v = 0; v < n; v++) {
+        if (get_station_status(&reseau, v) == CHARGEUR) stations[nb_stations++] = v;
+        cumul += get_vertix_attribute(&reseau, v, ATTR_POP);
+        source.pop_cumulee[v] = cumul;
+    }
+    for (int i = 0; i < gr.nb; i++) {
+        grappe_envoyer(&gr, i, MESSAGE_STATIONS, 0, stations, nb_stations * sizeof(int));
+    }
+    if (param.fichier != NULL) {
+        source.fichier = fopen(param.fichier, "r");
+        if (source.fichier == NULL) perror("Erreur d'ouverture du fichier de trajets");
+    }
+
+    /* Tours synchrones : injection des départs, puis un pas de chaque processus */
+    double t1 = secondes();
+    Tampon *entrants = calloc(gr.nb, sizeof(Tampon));
+    long tour = 0, id = 0, actifs = 0, max_actifs = 0, migrations = 0;
+    int depart, destination;
+    long tour_depart;
+    bool en_attente = trajet_suivant(&source, &depart, &destination, &tour_depart);
+    while (en_attente || actifs > 0) {
+        while (en_attente && actifs < param.taille_pool) {
+            if (tour_depart > tour) {
+                if (actifs > 0) break;
+                tour = tour_depart; // Réseau vide : on saute directement au prochain départ
+            }
+            VehiculeReparti v;
+            memset(&v, 0, sizeof(v));
+            v.id = (int)++id;
+            v.position = depart;
+            v.destination = destination;
+            v.cible = -1;
+            v.batterie = CAPACITE_BATTERIE;
+            v.entree = tour;
+            v.attente = tour - tour_depart;
+            tampon_ajouter(&entrants[gr.region[depart]], &v, sizeof(v));
+            actifs++;
+            en_attente = trajet_suivant(&source, &depart, &destination, &tour_depart);
+        }
+        if (actifs > max_actifs) max_actifs = actifs;
+
+        for (int i = 0; i < gr.nb; i++) {
+            grappe_envoyer(&gr, i, MESSAGE_TOUR, (int)tour, entrants[i].donnees, entrants[i].taille);
+            entrants[i].taille = 0;
+        }
+        for (int i = 0; i < gr.nb; i++) {
+            EnteteMessage e;
+            char *donnees = grappe_recevoir(&gr, i, MESSAGE_TOUR, &e);
+            actifs -= e.nb;
+            int nb = e.taille / sizeof(VehiculeReparti);
+            for (int j = 0; j < nb; j++) {
+                VehiculeReparti v;
+                memcpy(&v, donnees + j * sizeof(VehiculeReparti), sizeof(v));
+                tampon_ajouter(&entrants[gr.region[v.position]], &v, sizeof(v));
+            }
+            migrations += nb;
+            free(donnees);
+        }
+        tour++;
+    }
+
+    for (int i = 0; i < gr.nb; i++) {
+        grappe_envoyer(&gr, i, MESSAGE_BILAN, 0, NULL, 0);
+    }
+    for (int i = 0; i < gr.nb; i++) {
+        EnteteMessage e;
+        char *donnees = grappe_recevoir(&gr, i, MESSAGE_BILAN, &e);
+        BilanReparti b;
+        memcpy(&b, donnees, sizeof(b));
+        total.trajets += b.trajets;
+        total.arrives += b.arrives;
+        total.pannes += b.pannes;
+        total.autres += b.autres;
+        total.distance += b.distance;
+        total.duree_totale += b.duree_totale;
+        total.attente_totale += b.attente_totale;
+        if (b.duree_max > total.duree_max) total.duree_max = b.duree_max;
+        free(donnees);
+    }
+
+    printf("Simulation répartie terminée en %ld tours (%ld véhicules simultanés au maximum) en %.3f s\n",
+           tour, max_actifs, secondes() - t1);
+    printf("Passages de frontière : %ld véhicules / messages échangés : %ld (%.2f Mo)\n", migrations, gr.messages, gr.octets / 1e6);
+    total.invalides = source.invalides;
+    afficher_statistiques_flux(&total);
+
+    grappe_arreter(&gr);
+    if (source.fichier != NULL) fclose(source.fichier);
+    for (int i = 0; i < gr.nb; i++) {
+        free(entrants[i].donnees);
+    }
+    free(entrants);
+    free(stations);
+    free(source.pop_cumulee);
+    return total;
+}
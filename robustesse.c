@@ -0,0 +1,405 @@
+#include "tipe.h"
+#include <pthread.h>
+
+/*
+ * Robustesse de placements face à des scénarios de perturbation du réseau :
+ * routes fermées, routes ralenties (poids multiplié) et déplacements de
+ * population. Chaque scénario est tiré avec sa propre graine, donc le
+ * résultat ne dépend pas de l'ordre des threads.
+ *
+ * Un placement est jugé sur la distance moyenne par habitant à la station la
+ * plus proche (pondérée par la population du scénario, qui varie), et non sur
+ * le coût k-médian non pondéré de evaluer_placements(). Les distances
+ * depuis chaque station du réseau de base (et leurs arbres de plus courts
+ * chemins) sont calculées une fois et partagées entre les scénarios. Une
+ * route fermée ou ralentie n'invalide que le sous-arbre situé sous elle dans
+ * l'arbre d'une station : seuls ces sommets sont recalculés, par un Dijkstra
+ * limité amorcé depuis leurs voisins restés valides. Une route raccourcie
+ * (facteur_max < 1) impose de recalculer la ligne entière.
+ */
+
+typedef struct {
+    int position; // Position de l'arête dans la liste de son extrémité la plus petite
+    double ancien, nouveau;
+} Perturbation;
+
+typedef struct {
+    Csr *csr;
+    int *inverse; // Position de l'arc opposé dans le CSR
+    int *aretes; // Positions u → v avec u < v (une par arête)
+    int *origine; // Extrémité u de chaque position
+    int m;
+    double *pop;
+    int nb_stations; // Stations distinctes de tous les placements
+    int *stations;
+    double *lignes; // Distances de base depuis chaque station (nb_stations × n)
+    int *preds; // Arbres de plus courts chemins de base (nb_stations × n)
+    int *debut_enfants; // Enfants de v dans l'arbre de la station j :
+    int *enfants; // enfants[j·n + debut_enfants[j·(n+1) + v] ..]
+    Placement *placements;
+    int **indices; // Indice dans stations de chaque station de chaque placement
+    int nb_placements;
+    ParamScenarios p;
+    double *distances; // Distance moyenne par habitant : nb_placements × p.nb
+    long recalcules; // Sommets recalculés, toutes lignes confondues (partagé entre les threads)
+    int suivant; // Prochain scénario (partagé entre les threads)
+} TravailRobustesse;
+
+double aleatoire(unsigned int *graine) {
+    return (double)rand_r(graine) / RAND_MAX;
+}
+
+/* Distance moyenne par habitant au plus proche centre du placement, à partir
+ * des lignes de distances de ses stations ; INFINITY si un sommet peuplé
+ * n'a aucune station accessible. */
+double distance_habitant(double **lignes, int nb, int n, double *pop) {
+    double total = 0.0, habitants = 0.0;
+    for (int v = 0; v < n; v++) {
+        double d = INFINITY;
+        for (int i = 0; i < nb; i++) {
+            if (lignes[i][v] < d) d = lignes[i][v];
+        }
+        if (pop[v] > 0.0) total += pop[v] * d;
+        habitants += pop[v];
+    }
+    return habitants > 0.0 ? total / habitants : 0.0;
+}
+
+typedef struct { // Mémoire de travail d'un thread
+    double *poids; // Poids du scénario courant
+    Perturbation *perturbations;
+    double *pop;
+    double *recalcul; // Lignes recalculées (nb_stations × n)
+    double **lignes;
+    int *marque; // marque[v] == tampon : v est invalidé dans la ligne courante
+    int tampon;
+    int *invalides;
+} Scratch;
+
+/* Marque le sous-arbre de r dans l'arbre de la station j. */
+int invalider_sous_arbre(TravailRobustesse *t, Scratch *w, int j, int r, int nb) {
+    int n = t->csr->n;
+    const int *debut = &t->debut_enfants[(size_t)j * (n + 1)];
+    const int *enfants = &t->enfants[(size_t)j * n];
+    if (w->marque[r] == w->tampon) return nb;
+    int lu = nb;
+    w->marque[r] = w->tampon;
+    w->invalides[nb++] = r;
+    while (lu < nb) {
+        int x = w->invalides[lu++];
+        for (int i = debut[x]; i < debut[x+1]; i++) {
+            if (w->marque[enfants[i]] != w->tampon) {
+                w->marque[enfants[i]] = w->tampon;
+                w->invalides[nb++] = enfants[i];
+            }
+        }
+    }
+    return nb;
+}
+
+/* Ligne de la station j dans le scénario courant ; renvoie le nombre de
+ * sommets recalculés. */
+int ligne_scenario(TravailRobustesse *t, Scratch *w, int nb_perturbations, int j, double **ligne) {
+    int n = t->csr->n;
+    const double *base = &t->lignes[(size_t)j * n];
+    const int *pred = &t->preds[(size_t)j * n];
+    Csr c = { n, t->csr->debut, t->csr->voisins, w->poids };
+
+    w->tampon++;
+    int nb = 0;
+    for (int i = 0; i < nb_perturbations; i++) {
+        Perturbation *p = &w->perturbations[i];
+        int a = t->origine[p->position], b = t->csr->voisins[p->position];
+        if (p->nouveau < p->ancien) {
+            if (arete_affecte(base[a], base[b], p->ancien, p->nouveau, 0.0)) {
+                *ligne = &w->recalcul[(size_t)j * n];
+                dijkstra(&c, &t->stations[j], 1, *ligne, NULL);
+                return n;
+            }
+            continue;
+        }
+        if (pred[b] == a && base[a] + p->ancien == base[b]) nb = invalider_sous_arbre(t, w, j, b, nb);
+        if (pred[a] == b && base[b] + p->ancien == base[a]) nb = invalider_sous_arbre(t, w, j, a, nb);
+        if (nb > n / 2) break;
+    }
+    if (nb == 0) {
+        *ligne = (double *)base;
+        return 0;
+    }
+    if (nb > n / 2) { // Réparation plus chère qu'un Dijkstra complet
+        *ligne = &w->recalcul[(size_t)j * n];
+        dijkstra(&c, &t->stations[j], 1, *ligne, NULL);
+        return n;
+    }
+
+    /* Dijkstra limité aux sommets invalidés */
+    double *d = &w->recalcul[(size_t)j * n];
+    memcpy(d, base, n * sizeof(double));
+    Tas tas = tas_init(nb);
+    for (int i = 0; i < nb; i++) d[w->invalides[i]] = INFINITY;
+    for (int i = 0; i < nb; i++) {
+        int x = w->invalides[i];
+        for (int e = c.debut[x]; e < c.debut[x+1]; e++) {
+            int u = c.voisins[e];
+            if (w->marque[u] == w->tampon) continue;
+            if (d[u] + c.poids[e] < d[x]) d[x] = d[u] + c.poids[e];
+        }
+        if (!isinf(d[x])) tas_inserer(&tas, d[x], x);
+    }
+    while (!tas_vide(&tas)) {
+        ElementTas min = tas_extraire(&tas);
+        int x = min.val;
+        if (min.cle > d[x]) continue; // Entrée obsolète
+        for (int e = c.debut[x]; e < c.debut[x+1]; e++) {
+            int y = c.voisins[e];
+            if (w->marque[y] != w->tampon) continue;
+            double dy = min.cle + c.poids[e];
+            if (dy < d[y]) {
+                d[y] = dy;
+                tas_inserer(&tas, dy, y);
+            }
+        }
+    }
+    free_tas(&tas);
+    *ligne = d;
+    return nb;
+}
+
+void evaluer_scenario(TravailRobustesse *t, Scratch *w, int s) {
+    int n = t->csr->n;
+    unsigned int graine = t->p.graine + 7919u * (unsigned int)s;
+
+    /* Tirage des perturbations */
+    int nb = 0;
+    for (int e = 0; e < t->m; e++) {
+        int i = t->aretes[e];
+        double r = aleatoire(&graine);
+        double nouveau;
+        if (r < t->p.coupures) {
+            nouveau = INFINITY;
+        } else if (r < t->p.coupures + t->p.ralentissements) {
+            nouveau = w->poids[i] * (1.0 + (t->p.facteur_max - 1.0) * aleatoire(&graine));
+        } else {
+            continue;
+        }
+        w->perturbations[nb++] = (Perturbation){ i, w->poids[i], nouveau };
+        w->poids[i] = w->poids[t->inverse[i]] = nouveau;
+    }
+    for (int v = 0; v < n; v++) {
+        w->pop[v] = t->pop[v] * (1.0 - t->p.variation_pop + 2.0 * t->p.variation_pop * aleatoire(&graine));
+    }
+
+    double **ligne_station = malloc((t->nb_stations > 0 ? t->nb_stations : 1) * sizeof(double *));
+    long nb_recalcules = 0;
+    for (int j = 0; j < t->nb_stations; j++) {
+        nb_recalcules += ligne_scenario(t, w, nb, j, &ligne_station[j]);
+    }
+    __atomic_fetch_add(&t->recalcules, nb_recalcules, __ATOMIC_RELAXED);
+
+    for (int k = 0; k < t->nb_placements; k++) {
+        for (int i = 0; i < t->placements[k].nb; i++) {
+            w->lignes[i] = ligne_station[t->indices[k][i]];
+        }
+        t->distances[(size_t)k * t->p.nb + s] = distance_habitant(w->lignes, t->placements[k].nb, n, w->pop);
+    }
+
+    /* Retour au réseau de base */
+    for (int i = nb - 1; i >= 0; i--) {
+        w->poids[w->perturbations[i].position] = w->poids[t->inverse[w->perturbations[i].position]] = w->perturbations[i].ancien;
+    }
+    free(ligne_station);
+}
+
+void *evaluer_scenarios(void *arg) {
+    TravailRobustesse *t = arg;
+    int n = t->csr->n;
+    int k_max = 1;
+    for (int k = 0; k < t->nb_placements; k++) {
+        if (t->placements[k].nb > k_max) k_max = t->placements[k].nb;
+    }
+    Scratch w;
+    w.poids = malloc((t->csr->debut[n] > 0 ? t->csr->debut[n] : 1) * sizeof(double));
+    memcpy(w.poids, t->csr->poids, t->csr->debut[n] * sizeof(double));
+    w.perturbations = malloc((t->m > 0 ? t->m : 1) * sizeof(Perturbation));
+    w.pop = malloc(n * sizeof(double));
+    w.recalcul = malloc((size_t)(t->nb_stations > 0 ? t->nb_stations : 1) * n * sizeof(double));
+    w.lignes = malloc(k_max * sizeof(double *));
+    w.marque = calloc(n, sizeof(int));
+    w.tampon = 0;
+    w.invalides = malloc(n * sizeof(int));
+
+    int s;
+    while ((s = __atomic_fetch_add(&t->suivant, 1, __ATOMIC_RELAXED)) < t->p.nb) {
+        evaluer_scenario(t, &w, s);
+    }
+
+    free(w.poids);
+    free(w.perturbations);
+    free(w.pop);
+    free(w.recalcul);
+    free(w.lignes);
+    free(w.marque);
+    free(w.invalides);
+    return NULL;
+}
+/**
+ * Distance moyenne par habitant de chaque placement sur le réseau de base
+ * (base[k]) et dans chacun des p.nb scénarios perturbés du réseau g
+ * (distances[k·p.nb + s]), les scénarios étant évalués en parallèle.
+ */
+void robustesse_calculer(Graph *g, Placement *placements, int nb, ParamScenarios p, double *base, double *distances) {
+    Csr c = csr_from_graph(g);
+    int n = c.n;
+    double debut = secondes();
+
+    /* Arcs opposés et liste des arêtes */
+    int *inverse = malloc((c.debut[n] > 0 ? c.debut[n] : 1) * sizeof(int));
+    int *origine = malloc((c.debut[n] > 0 ? c.debut[n] : 1) * sizeof(int));
+    int *aretes = malloc((c.debut[n] > 0 ? c.debut[n] : 1) * sizeof(int));
+    bool *apparie = calloc(c.debut[n] > 0 ? c.debut[n] : 1, sizeof(bool));
+    int m = 0;
+    for (int u = 0; u < n; u++) {
+        for (int i = c.debut[u]; i < c.debut[u+1]; i++) {
+            origine[i] = u;
+            int v = c.voisins[i];
+            if (u >= v) continue; // Les boucles ne sont jamais perturbées
+            for (int j = c.debut[v]; j < c.debut[v+1]; j++) {
+                if (!apparie[j] && c.voisins[j] == u && c.poids[j] == c.poids[i]) {
+                    apparie[j] = true;
+                    inverse[i] = j;
+                    inverse[j] = i;
+                    break;
+                }
+            }
+            aretes[m++] = i;
+        }
+    }
+    free(apparie);
+
+    /* Stations distinctes et distances de base */
+    int *indice_station = malloc(n * sizeof(int));
+    for (int v = 0; v < n; v++) indice_station[v] = -1;
+    int nb_stations = 0;
+    int *stations = malloc(n * sizeof(int));
+    int **indices = malloc((nb > 0 ? nb : 1) * sizeof(int *));
+    for (int k = 0; k < nb; k++) {
+        indices[k] = malloc((placements[k].nb > 0 ? placements[k].nb : 1) * sizeof(int));
+        for (int i = 0; i < placements[k].nb; i++) {
+            int v = placements[k].sommets[i];
+            if (indice_station[v] == -1) {
+                indice_station[v] = nb_stations;
+                stations[nb_stations++] = v;
+            }
+            indices[k][i] = indice_station[v];
+        }
+    }
+    double *lignes = malloc((size_t)(nb_stations > 0 ? nb_stations : 1) * n * sizeof(double));
+    int *preds = malloc((size_t)(nb_stations > 0 ? nb_stations : 1) * n * sizeof(int));
+    int *debut_enfants = calloc((size_t)(nb_stations > 0 ? nb_stations : 1) * (n + 1), sizeof(int));
+    int *enfants = malloc((size_t)(nb_stations > 0 ? nb_stations : 1) * n * sizeof(int));
+    for (int j = 0; j < nb_stations; j++) {
+        int *pred = &preds[(size_t)j * n];
+        int *debut_j = &debut_enfants[(size_t)j * (n + 1)];
+        dijkstra(&c, &stations[j], 1, &lignes[(size_t)j * n], pred);
+        for (int v = 0; v < n; v++) {
+            if (pred[v] >= 0) debut_j[pred[v] + 1]++;
+        }
+        for (int v = 0; v < n; v++) debut_j[v+1] += debut_j[v];
+        for (int v = 0; v < n; v++) {
+            if (pred[v] >= 0) enfants[(size_t)j * n + debut_j[pred[v]]++] = v;
+        }
+        for (int v = n; v > 0; v--) debut_j[v] = debut_j[v-1]; // Décalage dû au remplissage
+        debut_j[0] = 0;
+    }
+    double *pop = malloc(n * sizeof(double));
+    for (int v = 0; v < n; v++) {
+        pop[v] = get_vertix_attribute(g, v, ATTR_POP);
+    }
+
+    /* Scénarios en parallèle */
+    TravailRobustesse t = { &c, inverse, aretes, origine, m, pop, nb_stations, stations, lignes, preds, debut_enfants, enfants,
+                            placements, indices, nb, p, distances, 0, 0 };
+    int nb_threads = nb_coeurs() < p.nb ? nb_coeurs() : p.nb;
+    pthread_t *threads = malloc((nb_threads > 0 ? nb_threads : 1) * sizeof(pthread_t));
+    for (int i = 0; i < nb_threads; i++) {
+        pthread_create(&threads[i], NULL, evaluer_scenarios, &t);
+    }
+    for (int i = 0; i < nb_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    printf("\nRobustesse : %d scénarios (%.1f %% de routes fermées, %.1f %% ralenties jusqu'à x%.2f, population ±%.0f %%)\n",
+           p.nb, 100 * p.coupures, 100 * p.ralentissements, p.facteur_max, 100 * p.variation_pop);
+    printf("%d placements, %d stations distinctes, %.1f %% des distances recalculées (%.2f s)\n", nb, nb_stations,
+           p.nb > 0 && nb_stations > 0 ? 100.0 * t.recalcules / ((double)p.nb * nb_stations * n) : 0.0, secondes() - debut);
+
+    double **ligne_base = malloc(n * sizeof(double *));
+    for (int k = 0; k < nb; k++) {
+        for (int i = 0; i < placements[k].nb; i++) {
+            ligne_base[i] = &lignes[(size_t)indices[k][i] * n];
+        }
+        base[k] = distance_habitant(ligne_base, placements[k].nb, n, pop);
+    }
+
+    for (int k = 0; k < nb; k++) {
+        free(indices[k]);
+    }
+    free(ligne_base);
+    free(indices);
+    free(indice_station);
+    free(stations);
+    free(lignes);
+    free(preds);
+    free(debut_enfants);
+    free(enfants);
+    free(pop);
+    free(inverse);
+    free(origine);
+    free(aretes);
+    free_csr(&c);
+}
+
+/**
+ * Évalue les placements sur p.nb scénarios perturbés du réseau g et affiche
+ * pour chacun la distance moyenne par habitant (en km) du réseau de base,
+ * puis sa moyenne, ses percentiles et son pire cas sur les scénarios.
+ */
+void robustesse_placements(Graph *g, Placement *placements, int nb, ParamScenarios p) {
+    double *base = malloc((nb > 0 ? nb : 1) * sizeof(double));
+    double *distances = malloc((size_t)(nb > 0 ? nb : 1) * (p.nb > 0 ? p.nb : 1) * sizeof(double));
+    robustesse_calculer(g, placements, nb, p, base, distances);
+
+    printf("\nDistance moyenne par habitant à la station la plus proche (km)\n");
+    printf("%-24s %4s %10s %10s %10s %10s %10s %10s %9s\n", "Placement", "k", "Base", "Moyenne", "p50", "p90", "p99", "Pire", "Isolés");
+    for (int k = 0; k < nb; k++) {
+        double *scenarios = &distances[(size_t)k * p.nb];
+        double somme = 0.0;
+        int finis = 0;
+        for (int s = 0; s < p.nb; s++) {
+            if (isinf(scenarios[s])) continue;
+            somme += scenarios[s];
+            finis++;
+        }
+        qsort(scenarios, p.nb, sizeof(double), comparer_reels);
+        printf("%-24s %4d %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f %8.1f%%\n", placements[k].nom, placements[k].nb, base[k],
+               finis > 0 ? somme / finis : INFINITY, percentile(scenarios, p.nb, 0.5), percentile(scenarios, p.nb, 0.9),
+               percentile(scenarios, p.nb, 0.99), percentile(scenarios, p.nb, 1.0),
+               p.nb > 0 ? 100.0 * (p.nb - finis) / p.nb : 0.0);
+    }
+    printf("(Isolés : part des scénarios où des habitants n'ont plus de station accessible ; la moyenne porte sur les autres)\n");
+
+    free(base);
+    free(distances);
+}
+
+/* Robustesse des placements de référence (voir comparer_placements()). */
+void comparer_robustesse(Graph *g, char *stations_file, int nb_aleatoires, ParamScenarios p) {
+    Placement *placements = malloc((nb_aleatoires + 3) * sizeof(Placement));
+    int nb = placements_reference(g, stations_file, nb_aleatoires, placements);
+    robustesse_placements(g, placements, nb, p);
+    for (int i = 0; i < nb; i++) {
+        free_placement(&placements[i]);
+    }
+    free(placements);
+}
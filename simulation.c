@@ -3,6 +3,7 @@
 Graph *graph;
 Vehicule *vehicules;
 int nb_vehicules;
+bool bavard; // Affichage de chaque événement (petites flottes uniquement)
 
 // Fonctions
 
@@ -10,256 +11,395 @@ void free_trafic() {
     if(vehicules != NULL) free(vehicules);
 }
 
+// Itinéraires
+
+/* Les itinéraires sont reconstruits à partir de la matrice des distances et
+ * du graphe CSR, sans Dijkstra par véhicule : la génération d'un trajet coûte
+ * O(longueur × degré + stations). */
+Csr csr;
+Distances distances;
+int *stations; // Sommets équipés d'un chargeur
+int nb_stations;
+bool *utilisee; // Stations déjà choisies comme étape du trajet en cours
+
+/* Ajoute à chemin le plus court chemin de u à t (u exclu), reconstruit saut
+ * par saut comme lot_ajouter_chemin() : le voisin suivant est celui par qui
+ * passe la distance de u à t. */
+void ajouter_segment(igraph_vector_int_t *chemin, int u, int t) {
+    for (int pas = 0; u != t && pas < csr.n; pas++) {
+        double reste = get_distance(&distances, u, t);
+        int suivant = -1;
+        double meilleur = INFINITY;
+        for (int e = csr.debut[u]; e < csr.debut[u+1]; e++) {
+            double via = csr.poids[e] + get_distance(&distances, csr.voisins[e], t);
+            if (via < meilleur) {
+                meilleur = via;
+                suivant = csr.voisins[e];
+            }
+        }
+        if (suivant == -1 || fabs(meilleur - reste) > 1e-9 * (1.0 + reste) + tolerance_distances(&distances, reste)) return;
+        igraph_vector_int_push_back(chemin, suivant);
+        u = suivant;
+    }
+}
+
 /**
  * Détermine le parcours complet d'un véhicule en tenant compte de son autonomie.
  * - Si l’autonomie restante suffit pour atteindre la destination, on renvoie
- *   directement le plus court chemin (Dijkstra).
- * - Sinon, on choisit récursivement la station de recharge la plus éloignée
- *   encore atteignable, on “recharge” (batterie remise à CAPACITE_BATTERIE)
- *   puis on poursuit jusqu’à destination.
+ *   directement le plus court chemin.
+ * - Sinon, on choisit la station de recharge la plus éloignée encore
+ *   atteignable, on “recharge” (batterie remise à CAPACITE_BATTERIE) puis on
+ *   poursuit jusqu’à destination. Une station n'est utilisée qu'une fois :
+ *   évite d'osciller entre deux stations quand la destination reste hors
+ *   d'atteinte.
  *
  * Le résultat est un igraph_vector_int_t contenant la suite des sommets.
  */
 igraph_vector_int_t get_chemin(Graph *graph, Vehicule v) {
-
+    (void)graph;
     igraph_vector_int_t chemin;
     igraph_vector_int_init(&chemin, 0);
+    igraph_vector_int_push_back(&chemin, v.depart);
 
-    /* Récupération des poids de toutes les arêtes */
-    igraph_vector_t poids;
-    igraph_vector_init(&poids, 0);
-    igraph_es_t aretes;
-    igraph_es_all(&aretes, IGRAPH_EDGEORDER_ID);
-    igraph_cattribute_EANV(graph, ATTR_WEIGHT, aretes, &poids);
-
-    igraph_integer_t courant = v.depart;
+    int courant = v.depart;
     double batterie = v.batterie;
-
     while (courant != v.destination) {
-        /* Plus court chemin courant → destination */
-        igraph_vector_int_t segment;
-        igraph_vector_int_init(&segment, 0);
-        if (igraph_get_shortest_path_dijkstra(graph, &segment, NULL, courant, v.destination, &poids, IGRAPH_OUT) != IGRAPH_SUCCESS) {
-            /* Pas de chemin : on renvoie ce qu’on a déjà */
-            igraph_vector_int_destroy(&segment);
-            break;
-        }
-
-        /* Distance (en km) et consommation (kWh) du segment */
-        double dist_seg = 0.0;
-        for (long k = 0; k < igraph_vector_int_size(&segment) - 1; k++) {
-            igraph_integer_t u = VECTOR(segment)[k];
-            igraph_integer_t v = VECTOR(segment)[k + 1];
-            igraph_integer_t eid;
-            igraph_get_eid(graph, &eid, u, v, IGRAPH_UNDIRECTED, 0);
-            dist_seg += VECTOR(poids)[eid];
-        }
-        double conso_seg = dist_seg * CONSOMMATION;
-
-        if (conso_seg <= batterie) {
-            /* Segment faisable : on l’ajoute et on termine */
-            if (igraph_vector_int_size(&chemin) == 0)
-                igraph_vector_int_append(&chemin, &segment);
-            else
-                for (long k = 1; k < igraph_vector_int_size(&segment); k++)
-                    igraph_vector_int_push_back(&chemin, VECTOR(segment)[k]);
-
-            igraph_vector_int_destroy(&segment);
+        double reste = get_distance(&distances, courant, v.destination);
+        if (isinf(reste)) break; // Pas de chemin : on renvoie ce qu’on a déjà
+        if (reste * CONSOMMATION <= batterie) {
+            ajouter_segment(&chemin, courant, v.destination);
             break;
         }
 
         /* Sinon, chercher la station atteignable la plus éloignée */
-        igraph_integer_t best_station = -1;
+        int best_station = -1;
         double best_dist = -1.0;
-        igraph_vector_int_t best_seg;
-        igraph_vector_int_init(&best_seg, 0);
-
-        for (igraph_integer_t v = 0; v < vertices_count(graph); v++) {
-            if (!get_vertix_attribute(graph, v, ATTR_STATION))
-                continue;
-
-            igraph_vector_int_t tmp;
-            igraph_vector_int_init(&tmp, 0);
-            if (igraph_get_shortest_path_dijkstra(graph, &tmp, NULL, courant, v, &poids, IGRAPH_OUT) != IGRAPH_SUCCESS) {
-                igraph_vector_int_destroy(&tmp);
-                continue;
-            }
-
-            double dist_tmp = 0.0;
-            for (long k = 0; k < igraph_vector_int_size(&tmp) - 1; k++) {
-                igraph_integer_t a = VECTOR(tmp)[k];
-                igraph_integer_t b = VECTOR(tmp)[k + 1];
-                igraph_integer_t eid;
-                igraph_get_eid(graph, &eid, a, b, IGRAPH_UNDIRECTED, 0);
-                dist_tmp += VECTOR(poids)[eid];
-            }
-
-            if (dist_tmp * CONSOMMATION <= batterie && dist_tmp > best_dist) {
-                best_dist = dist_tmp;
-                best_station = v;
-                igraph_vector_int_destroy(&best_seg);
-                best_seg = tmp;
-            } else {
-                igraph_vector_int_destroy(&tmp);
+        for (int i = 0; i < nb_stations; i++) {
+            double d = get_distance(&distances, courant, stations[i]);
+            if (!utilisee[i] && d * CONSOMMATION <= batterie && d > best_dist) {
+                best_dist = d;
+                best_station = i;
             }
         }
+        if (best_station == -1) break; // Erreur : Aucune station atteignable
 
-        if (best_station == -1) {
-            /* Erreur : Aucune station atteignable */
-            igraph_vector_int_destroy(&segment);
-            break;
-        }
-
-        /* Ajout du segment jusqu’à la station */
-        if (igraph_vector_int_size(&chemin) == 0){
-            igraph_vector_int_append(&chemin, &best_seg);
-        } else{
-            for (long k = 1; k < igraph_vector_int_size(&best_seg); k++) {
-                igraph_vector_int_push_back(&chemin, VECTOR(best_seg)[k]);
-            }
-        }
-
-        courant = best_station;     /* On se trouve maintenant à la station */
-        batterie = v.batterie;      /* Recharge complète */
-        igraph_vector_int_destroy(&segment);
-        igraph_vector_int_destroy(&best_seg);
+        utilisee[best_station] = true;
+        ajouter_segment(&chemin, courant, stations[best_station]);
+        courant = stations[best_station]; /* On se trouve maintenant à la station */
+        batterie = v.batterie;            /* Recharge complète */
     }
 
-    igraph_vector_destroy(&poids);
-    igraph_es_destroy(&aretes);
+    memset(utilisee, 0, nb_stations * sizeof(bool));
     return chemin;
 }
 
 void generer_trafic(int n) {
-    srand(time(NULL));
+    unsigned int graine = time(NULL);
     nb_vehicules = n;
     free_trafic();
     Vehicule* res = malloc(n*sizeof(Vehicule));
 
-    double total_pop = 0.0;
-    for (igraph_integer_t v = 0; v < vertices_count(graph); v++) {
-        total_pop += get_vertix_attribute(graph, v, ATTR_POP);
+    int nb_sommets = vertices_count(graph);
+    double *pop_cumulee = malloc(nb_sommets * sizeof(double));
+    double cumul = 0.0;
+    for (int v = 0; v < nb_sommets; v++) {
+        cumul += get_vertix_attribute(graph, v, ATTR_POP);
+        pop_cumulee[v] = cumul;
     }
 
     for(int i = 0; i < n; i++) {
         res[i].id = i+1;
-        double r = ((double) rand() / RAND_MAX) * total_pop;
-        double cumulative = 0.0;
-        igraph_integer_t depart = 0;
-        for (igraph_integer_t vtx = 0; vtx < vertices_count(graph); vtx++) {
-            cumulative += get_vertix_attribute(graph, vtx, ATTR_POP);
-            if (r <= cumulative) {
-                depart = vtx;
-                break;
-            }
-        }
+        int depart = tirer_pondere(pop_cumulee, nb_sommets, &graine); // Départ proportionnel à la population
         res[i].depart = depart;
         res[i].position = depart;
         do {
-            res[i].destination = rand() % vertices_count(graph); // Aléatoire qui prend en compte la population
+            res[i].destination = rand_r(&graine) % nb_sommets;
         } while (res[i].destination == res[i].depart);
         res[i].batterie = CAPACITE_BATTERIE;
         res[i].statut = EN_MARCHE;
         res[i].distance = 0.0f;
-        printf("Véhicule %i généré (%i -> %i)\n", res[i].id, res[i].depart, res[i].destination);
+        res[i].etape = 0;
+        res[i].attente = 0.0f;
+        if (bavard) printf("Véhicule %i généré (%i -> %i)\n", res[i].id, res[i].depart, res[i].destination);
         /* Calcul du chemin complet en tenant compte de l'autonomie */
         res[i].chemin = get_chemin(graph, res[i]);
     }
 
+    free(pop_cumulee);
     vehicules = res;
 }
 
-bool est_finie() { // Vérifie si la simulation est terminée (i.e. tous les véhicules ne sont plus "EN_MARCHE" ou "EN_CHARGE")
-    for(int i = 0; i < nb_vehicules; i++) {
-        Vehicule v = vehicules[i];
-        Statut statut = v.statut;
-        if(statut == EN_MARCHE || statut == EN_CHARGE) {
-            return false;
+// Stations de recharge
+
+/* Chaque station a un nombre fini de bornes d'une puissance donnée ; un
+ * véhicule qui n'en trouve pas de libre attend dans une file FIFO. */
+typedef struct {
+    int bornes, occupees;
+    double puissance; // En kW
+    int *file; // File circulaire des véhicules en attente
+    int tete, taille, capacite;
+    long recharges;
+    double temps_occupe, attente_totale; // En heures
+    int file_max;
+} PointDeCharge;
+
+PointDeCharge *points;
+Tas evenements; // Un événement par véhicule en mouvement ou en charge, ordonné par heure
+double horloge; // En heures
+double *attentes; // Attente (h) de chaque recharge, pour les percentiles
+long nb_attentes, capacite_attentes;
+double *debut_attente;
+bool *devie;
+
+void init_points_de_charge() {
+    int n = vertices_count(graph);
+    points = calloc(n, sizeof(PointDeCharge));
+    bool bornes_definies = has_vertix_attribute(graph, ATTR_BORNES);
+    bool puissance_definie = has_vertix_attribute(graph, ATTR_PUISSANCE);
+    stations = malloc((n > 0 ? n : 1) * sizeof(int));
+    nb_stations = 0;
+    for (int s = 0; s < n; s++) {
+        if (get_station_status(graph, s) != CHARGEUR) continue;
+        stations[nb_stations++] = s;
+        PointDeCharge *p = &points[s];
+        // Lu en double : convertir NaN ou une valeur hors des int est indéfini
+        double bornes = bornes_definies ? get_vertix_attribute(graph, s, ATTR_BORNES) : BORNES_PAR_STATION;
+        p->puissance = puissance_definie ? get_vertix_attribute(graph, s, ATTR_PUISSANCE) : PUISSANCE_BORNE;
+        if (isnan(bornes) || bornes < 1 || bornes > INT_MAX || isnan(p->puissance) || p->puissance <= 0) {
+            p->bornes = BORNES_PAR_STATION;
+            p->puissance = PUISSANCE_BORNE;
+        } else {
+            p->bornes = (int)bornes;
         }
+        p->capacite = 4;
+        p->file = malloc(p->capacite * sizeof(int));
     }
-    return true;
+    utilisee = calloc(nb_stations > 0 ? nb_stations : 1, sizeof(bool));
 }
 
-void simuler_tour() {
-    printf("----- Début Tour -----\n");
+void free_points_de_charge() {
+    for (int s = 0; s < vertices_count(graph); s++) {
+        free(points[s].file);
+    }
+    free(points);
+    free(stations);
+    free(utilisee);
+}
 
-    /* Préparer le vecteur des poids d’arêtes (longueur en km) */
-    igraph_vector_t poids;
-    igraph_vector_init(&poids, 0);
-    igraph_es_t aretes;
-    igraph_es_all(&aretes, IGRAPH_EDGEORDER_ID);
-    igraph_cattribute_EANV(graph, ATTR_WEIGHT, aretes, &poids);
+void file_ajouter(PointDeCharge *p, int i) {
+    if (p->taille == p->capacite) {
+        int *file = malloc(2 * p->capacite * sizeof(int));
+        for (int k = 0; k < p->taille; k++) {
+            file[k] = p->file[(p->tete + k) % p->capacite];
+        }
+        free(p->file);
+        p->file = file;
+        p->tete = 0;
+        p->capacite *= 2;
+    }
+    p->file[(p->tete + p->taille) % p->capacite] = i;
+    p->taille++;
+    if (p->taille > p->file_max) p->file_max = p->taille;
+}
 
-    for (int i = 0; i < nb_vehicules; i++) {
-        Vehicule *v = &vehicules[i];
+int file_extraire(PointDeCharge *p) {
+    int i = p->file[p->tete];
+    p->tete = (p->tete + 1) % p->capacite;
+    p->taille--;
+    return i;
+}
 
-        /* On ne traite que les véhicules encore en marche */
-        if (v->statut != EN_MARCHE)
-            continue;
+// Événements
 
-        igraph_vector_int_t *chemin = &v->chemin;
+double poids_arete(int a, int b) {
+    for (int e = csr.debut[a]; e < csr.debut[a+1]; e++) {
+        if (csr.voisins[e] == b) return csr.poids[e];
+    }
+    return -1.0;
+}
 
-        /* Chercher la position courante dans le chemin pré‑calculé */
-        long idx = -1;
-        for (long k = 0; k < igraph_vector_int_size(chemin); k++) {
-            if ((int)VECTOR(*chemin)[k] == v->position) {
-                idx = k;
-                break;
-            }
-        }
+/* Le véhicule doit-il recharger ici ? Oui si sa batterie ne suffit pas pour
+ * atteindre la prochaine station de son itinéraire (ou sa destination). */
+bool recharge_necessaire(Vehicule *v) {
+    if (v->batterie >= CAPACITE_BATTERIE - 1e-9) return false;
+    igraph_vector_int_t *chemin = &v->chemin;
+    double conso = 0.0;
+    for (long k = v->etape; k + 1 < igraph_vector_int_size(chemin); k++) {
+        int a = (int)VECTOR(*chemin)[k], b = (int)VECTOR(*chemin)[k + 1];
+        conso += poids_arete(a, b) * CONSOMMATION;
+        if (conso > v->batterie + 1e-9) return true;
+        if (b == v->destination || points[b].bornes > 0) break;
+    }
+    return false;
+}
+
+void demarrer_recharge(int i, double t) {
+    Vehicule *v = &vehicules[i];
+    PointDeCharge *p = &points[v->position];
+    double duree = (CAPACITE_BATTERIE - v->batterie) / p->puissance;
+    p->occupees++;
+    p->recharges++;
+    p->temps_occupe += duree;
+    if (nb_attentes == capacite_attentes) {
+        capacite_attentes *= 2;
+        attentes = realloc(attentes, capacite_attentes * sizeof(double));
+    }
+    attentes[nb_attentes++] = t - debut_attente[i];
+    p->attente_totale += t - debut_attente[i];
+    v->attente += t - debut_attente[i];
+    v->statut = EN_CHARGE;
+    tas_inserer(&evenements, t + duree, i);
+    if (bavard) {
+        printf("[%6.2fh] Véhicule %d : début de recharge à la station %d (%.0f min)\n", t, v->id, v->position, duree * 60);
+    }
+}
 
-        /* Sécurité : la position devrait toujours être trouvée */
-        if (idx == -1 || idx + 1 >= igraph_vector_int_size(chemin)) {
-            printf("Véhicule %d : position %d introuvable dans son chemin - abandon\n", v->id, v->position);
-            v->statut = AUTRE;
-            continue;
+void partir(int i, double t) {
+    Vehicule *v = &vehicules[i];
+    igraph_vector_int_t *chemin = &v->chemin;
+    if (v->etape + 1 >= igraph_vector_int_size(chemin)) {
+        if (bavard) printf("Véhicule %d : itinéraire interrompu en %d - abandon\n", v->id, v->position);
+        v->statut = AUTRE;
+        return;
+    }
+
+    int prochain_sommet = (int)VECTOR(*chemin)[v->etape + 1];
+    double distance_arc = poids_arete(v->position, prochain_sommet);
+    if (distance_arc < 0) {
+        printf("Erreur : aucune arête entre %d et %d\n", v->position, prochain_sommet);
+        v->statut = AUTRE;
+        return;
+    }
+    double conso = distance_arc * CONSOMMATION;
+    if (conso > v->batterie + 1e-9) {
+        if (bavard) {
+            printf("Véhicule %d : panne sèche anticipée (%.2f kWh requis, %.2f kWh restants)\n", v->id, conso, v->batterie);
         }
+        v->statut = EN_PANNE;
+        return;
+    }
 
-        int prochain_sommet = (int)VECTOR(*chemin)[idx + 1];
+    v->statut = EN_MARCHE;
+    tas_inserer(&evenements, t + distance_arc / VITESSE_MOYENNE, i);
+}
 
-        /* Consommation et distance pour l’arête courante */
-        igraph_integer_t eid;
-        if (igraph_get_eid(graph, &eid, v->position, prochain_sommet, IGRAPH_UNDIRECTED, 0) != IGRAPH_SUCCESS || eid == -1) {
-            printf("Erreur : aucune arête entre %d et %d\n", v->position, prochain_sommet);
-            v->statut = AUTRE;
-            continue;
+/* Si la file de la station est trop longue, tente une autre station
+ * atteignable avec la batterie restante, au plus une fois par trajet. */
+bool devier(int i, double t) {
+    Vehicule *v = &vehicules[i];
+    PointDeCharge *p = &points[v->position];
+    if (DEVIATION_FILE <= 0 || devie[i] || p->taille < DEVIATION_FILE) return false;
+
+    int best_station = -1;
+    double best_dist = +DBL_MAX;
+    for (int k = 0; k < nb_stations; k++) {
+        int s = stations[k];
+        PointDeCharge *q = &points[s];
+        if (s == v->position) continue;
+        if (q->occupees == q->bornes && q->taille >= p->taille) continue;
+        double d = get_distance(&distances, v->position, s);
+        if (d * CONSOMMATION <= v->batterie && d < best_dist) {
+            best_dist = d;
+            best_station = s;
         }
+    }
+    if (best_station == -1) return false;
+
+    /* Nouvel itinéraire : station de repli puis destination */
+    Vehicule vers_station = *v, vers_destination = *v;
+    vers_station.depart = v->position;
+    vers_station.destination = best_station;
+    vers_destination.depart = best_station;
+    vers_destination.batterie = CAPACITE_BATTERIE;
+    igraph_vector_int_t debut = get_chemin(graph, vers_station);
+    igraph_vector_int_t fin = get_chemin(graph, vers_destination);
+    for (long k = 1; k < igraph_vector_int_size(&fin); k++) {
+        igraph_vector_int_push_back(&debut, VECTOR(fin)[k]);
+    }
+    igraph_vector_int_destroy(&fin);
+    igraph_vector_int_destroy(&v->chemin);
+    v->chemin = debut;
+    v->etape = 0;
+    devie[i] = true;
+
+    if (bavard) {
+        printf("[%6.2fh] Véhicule %d : file de %d véhicules à la station %d, déviation vers %d\n",
+               t, v->id, p->taille, v->position, best_station);
+    }
+    partir(i, t);
+    return true;
+}
 
-        double distance_arc = VECTOR(poids)[eid];
-        double conso = distance_arc * CONSOMMATION;
+void arriver_sommet(int i, double t) {
+    Vehicule *v = &vehicules[i];
+    if (v->position == v->destination) {
+        v->statut = ARRIVE;
+        if (bavard) printf("[%6.2fh] Véhicule %d : arrivé à destination 🎉\n", t, v->id);
+        return;
+    }
 
-        if (conso > v->batterie + 1e-9) {
-            printf("Véhicule %d : panne sèche anticipée (%.2f kWh requis, %.2f kWh restants)\n",
-                   v->id, conso, v->batterie);
-            v->statut = EN_PANNE;
-            continue;
+    PointDeCharge *p = &points[v->position];
+    if (p->bornes > 0 && recharge_necessaire(v)) {
+        debut_attente[i] = t;
+        if (p->occupees < p->bornes) {
+            demarrer_recharge(i, t);
+        } else if (!devier(i, t)) {
+            v->statut = EN_ATTENTE;
+            file_ajouter(p, i);
+            if (bavard) {
+                printf("[%6.2fh] Véhicule %d : attend une borne à la station %d (%d en file)\n", t, v->id, v->position, p->taille);
+            }
         }
+        return;
+    }
 
-        v->batterie -= conso;
-        v->distance += distance_arc;
-        printf("Véhicule %d : %d → %d (%.2f km | -%.2f kWh, reste %.2f kWh)\n",
-               v->id, v->position, prochain_sommet,
-               distance_arc, conso, v->batterie);
+    partir(i, t);
+}
 
-        v->position = prochain_sommet;
+void fin_recharge(int i, double t) {
+    Vehicule *v = &vehicules[i];
+    PointDeCharge *p = &points[v->position];
+    v->batterie = CAPACITE_BATTERIE;
+    p->occupees--;
+    if (bavard) printf("[%6.2fh] Véhicule %d : recharge complète à la station %d\n", t, v->id, v->position);
+    if (p->taille > 0) {
+        demarrer_recharge(file_extraire(p), t);
+    }
+    partir(i, t);
+}
 
-        /* Recharge instantanée si on est sur une station (et pas à destination) */
-        if (get_vertix_attribute(graph, prochain_sommet, ATTR_STATION) && prochain_sommet != v->destination) {
-            v->batterie = CAPACITE_BATTERIE;
-            printf("Véhicule %d : recharge complète à la station %d (%.2f kWh)\n",
-                   v->id, prochain_sommet, v->batterie);
-        }
+void traiter_evenement(ElementTas e) {
+    int i = e.val;
+    Vehicule *v = &vehicules[i];
+    horloge = e.cle;
 
-        /* Arrivée ? */
-        if (prochain_sommet == v->destination) {
-            v->statut = ARRIVE;
-            printf("Véhicule %d : arrivé à destination 🎉\n", v->id);
-        }
+    if (v->statut == EN_CHARGE) {
+        fin_recharge(i, horloge);
+        return;
     }
 
-    igraph_vector_destroy(&poids);
-    igraph_es_destroy(&aretes);
-    printf("----- Fin Tour -----\n");
+    /* Fin de parcours d'une arête */
+    int prochain_sommet = (int)VECTOR(v->chemin)[v->etape + 1];
+    double distance_arc = poids_arete(v->position, prochain_sommet);
+    v->batterie -= distance_arc * CONSOMMATION;
+    v->distance += distance_arc;
+    if (bavard) {
+        printf("[%6.2fh] Véhicule %d : %d → %d (%.2f km | -%.2f kWh, reste %.2f kWh)\n", horloge,
+               v->id, v->position, prochain_sommet, distance_arc, distance_arc * CONSOMMATION, v->batterie);
+    }
+    v->position = prochain_sommet;
+    v->etape++;
+    arriver_sommet(i, horloge);
+}
+
+int comparer_reels(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+double percentile(double *valeurs, long nb, double q) {
+    if (nb == 0) return 0.0;
+    return valeurs[(long)(q * (nb - 1))];
 }
 
 void afficher_statistiques() {
@@ -268,7 +408,10 @@ void afficher_statistiques() {
     for(int i = 0; i < nb_vehicules; i++) {
         Vehicule v = vehicules[i];
         total_distance += v.distance;
-        printf("Véhicule %i : %.2fkm parcourus / %.2fkWh consommés / %.2fkWh restants\n", v.id, v.distance, v.distance*CONSOMMATION, v.batterie);
+        if (bavard) {
+            printf("Véhicule %i : %.2fkm parcourus / %.2fkWh consommés / %.2fkWh restants / %.0f min d'attente\n",
+                   v.id, v.distance, v.distance*CONSOMMATION, v.batterie, v.attente * 60);
+        }
         switch (v.statut) {
         case ARRIVE:
             arrive++;
@@ -287,18 +430,63 @@ void afficher_statistiques() {
     printf("Total consommé : %.2f kWh\n", total_distance*CONSOMMATION);
     printf("Total non-émis : %.2f kgCO2\n", (total_distance*CO2_EMIS)/1000.0);
     printf("Total statut : %i arrivés / %i en panne / %i autre\n", arrive, panne, autre);
+
+    qsort(attentes, nb_attentes, sizeof(double), comparer_reels);
+    printf("Recharges : %ld / attente p50 %.1f min / p90 %.1f min / p99 %.1f min / max %.1f min\n", nb_attentes,
+           percentile(attentes, nb_attentes, 0.5) * 60, percentile(attentes, nb_attentes, 0.9) * 60,
+           percentile(attentes, nb_attentes, 0.99) * 60, percentile(attentes, nb_attentes, 1.0) * 60);
+    printf("Station | bornes | puissance | recharges | attente moy. | file max | utilisation (sur %.2fh)\n", horloge);
+    for (int s = 0; s < vertices_count(graph); s++) {
+        PointDeCharge *p = &points[s];
+        if (p->bornes == 0) continue;
+        double utilisation = horloge > 0 ? 100.0 * p->temps_occupe / (p->bornes * horloge) : 0.0;
+        printf("%7d | %6d | %6.0f kW | %9ld | %8.1f min | %8d | %6.1f %%\n", s, p->bornes, p->puissance, p->recharges,
+               p->recharges > 0 ? 60 * p->attente_totale / p->recharges : 0.0, p->file_max, utilisation);
+    }
 }
 
 // Simulation
 
+/**
+ * Simulation à événements discrets : les véhicules parcourent les arêtes à
+ * VITESSE_MOYENNE, occupent une borne le temps de recharger (énergie /
+ * puissance) ou attendent leur tour dans la file de la station. Chaque
+ * événement coûte O(log n) (tas) et chaque file d'attente O(1) ; les
+ * itinéraires sont lus dans la matrice des distances, sans Dijkstra par
+ * véhicule.
+ */
 void simulation(Graph reseau, int nb_trafic) {
     printf("Simulation\n");
     graph = malloc(sizeof(Graph));
     *graph = reseau;
+    bavard = nb_trafic <= AFFICHAGE_MAX_VEHICULES;
+    csr = csr_from_graph(graph);
+    distances = distances_charger(graph, CACHE_DISTANCES, FORMAT_CACHE);
+    init_points_de_charge();
     generer_trafic(nb_trafic);
-    while(!est_finie()) {
-        simuler_tour();
+    evenements = tas_init(nb_vehicules);
+    capacite_attentes = nb_vehicules + 1;
+    attentes = malloc(capacite_attentes * sizeof(double));
+    nb_attentes = 0;
+    debut_attente = calloc(nb_vehicules, sizeof(double));
+    devie = calloc(nb_vehicules, sizeof(bool));
+    horloge = 0.0;
+
+    for (int i = 0; i < nb_vehicules; i++) {
+        arriver_sommet(i, 0.0);
+    }
+    while (!tas_vide(&evenements)) {
+        ElementTas e = tas_extraire(&evenements);
+        traiter_evenement(e);
     }
     printf("Fini!\n");
     afficher_statistiques();
+
+    free_tas(&evenements);
+    free_points_de_charge();
+    free_distances(&distances);
+    free_csr(&csr);
+    free(attentes);
+    free(debut_attente);
+    free(devie);
 }
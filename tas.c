@@ -0,0 +1,66 @@
+#include "tipe.h"
+
+/*
+ * Tas binaire minimum de couples (clé, valeur).
+ * Utilisé « paresseusement » par Dijkstra : un sommet peut être inséré
+ * plusieurs fois, les entrées obsolètes sont ignorées à l'extraction.
+ */
+
+Tas tas_init(int capacite) {
+    Tas t;
+    t.capacite = capacite > 0 ? capacite : 16;
+    t.taille = 0;
+    t.elements = malloc(t.capacite * sizeof(ElementTas));
+    if (t.elements == NULL) {
+        fprintf(stderr, "Erreur : impossible d'allouer le tas.\n");
+        exit(EXIT_FAILURE);
+    }
+    return t;
+}
+
+void free_tas(Tas *t) {
+    free(t->elements);
+    t->elements = NULL;
+    t->taille = t->capacite = 0;
+}
+
+bool tas_vide(Tas *t) {
+    return t->taille == 0;
+}
+
+void tas_inserer(Tas *t, double cle, int val) {
+    if (t->taille == t->capacite) {
+        t->capacite *= 2;
+        t->elements = realloc(t->elements, t->capacite * sizeof(ElementTas));
+        if (t->elements == NULL) {
+            fprintf(stderr, "Erreur : impossible d'agrandir le tas.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    int i = t->taille++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (t->elements[parent].cle <= cle) break;
+        t->elements[i] = t->elements[parent];
+        i = parent;
+    }
+    t->elements[i].cle = cle;
+    t->elements[i].val = val;
+}
+
+ElementTas tas_extraire(Tas *t) {
+    assert(t->taille > 0);
+    ElementTas min = t->elements[0];
+    ElementTas dernier = t->elements[--t->taille];
+    int i = 0;
+    while (true) {
+        int fils = 2 * i + 1;
+        if (fils >= t->taille) break;
+        if (fils + 1 < t->taille && t->elements[fils + 1].cle < t->elements[fils].cle) fils++;
+        if (dernier.cle <= t->elements[fils].cle) break;
+        t->elements[i] = t->elements[fils];
+        i = fils;
+    }
+    if (t->taille > 0) t->elements[i] = dernier;
+    return min;
+}
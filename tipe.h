@@ -3,8 +3,10 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <assert.h>
 #include <float.h>
+#include <limits.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
@@ -14,6 +16,13 @@
 #define MAX_SOMMETS 100 // Nombre maximum de sommets par graphe
 #define CAPACITE_BATTERIE 50 // Capacité en kWh de la batterie
 #define CONSOMMATION 0.2f // Quantité de kWh (batterie) consommée pour 1km parcouru
+#define AUTONOMIE (CAPACITE_BATTERIE / CONSOMMATION) // Distance en km parcourue avec une batterie pleine
+#define RAYON_COUVERTURE (AUTONOMIE / 2) // Un sommet est couvert s'il peut faire l'aller-retour vers un chargeur
+#define VITESSE_MOYENNE 90.0 // Vitesse moyenne en km/h
+#define BORNES_PAR_STATION 2 // Nombre de bornes d'une station (si l'attribut ATTR_BORNES est absent)
+#define PUISSANCE_BORNE 50.0 // Puissance en kW d'une borne (si l'attribut ATTR_PUISSANCE est absent)
+#define DEVIATION_FILE 4 // Longueur de file à partir de laquelle un véhicule cherche une autre station (0 : jamais)
+#define AFFICHAGE_MAX_VEHICULES 100 // Au-delà, la simulation n'affiche plus chaque événement
 #define CO2_EMIS 110 // Masse de CO2 émise pour 1km parcouru
 #define POIDS_MAX 200 // Poids maximum pour une arête (pour génération aléatoire)
 #define POIDS_MIN 10 // Poids minimum pour une arête (pour une génération aléatoire)
@@ -23,16 +32,37 @@
 #define ATTR_WEIGHT "poids" // Attribut pour le poids des arêtes
 #define ATTR_POP "population" // Attribut pour la population
 #define ATTR_STATION "station" // Attribut pour le type de station
+#define ATTR_BORNES "bornes" // Attribut pour le nombre de bornes d'une station
+#define ATTR_PUISSANCE "puissance" // Attribut pour la puissance des bornes d'une station (kW)
 #define ATTR_COORD_X "x" // Attribut pour la coordonnée x
 #define ATTR_COORD_Y "y" // Attribut pour la coordonnée y
 #define ATTR_LONG ATTR_COORD_X // Attribut pour la longitude
 #define ATTR_LAT ATTR_COORD_Y // Attribut pour la latitude
+#define RAYON_TERRE 6371.0 // Rayon moyen de la Terre en km
+#define ARRETS_IMPOSSIBLE 255 // Nombre d'arrêts d'un trajet infaisable
+#define K_VOISINS 3 // Nombre de voisins par sommet pour un graphe construit automatiquement
+#define FACTEUR_DETOUR 1.3 // Rapport moyen entre distance routière et distance à vol d'oiseau
 #define CSV_SKIP_LINE '#' // Caractère pour ignorer une ligne dans le CSV
+#define TAILLE_LOT 1024 // Nombre de trajets par lot dans la simulation en flux
+#define CAPACITE_FILE 8 // Nombre de lots en attente entre deux étapes de la simulation en flux
+#define NB_THREADS_ROUTAGE 4 // Nombre de threads calculant les itinéraires en flux
+#define SEUIL_LOD 2000 // Au-delà de ce nombre de sommets, l'export regroupe les sommets par case de grille
+#define DEGRE_LOD 6 // Degré à partir duquel un sommet reste visible dans un export simplifié
+#define CACHE_DISTANCES "distances" // Préfixe des fichiers cache des plus courtes distances (NULL : toujours recalculer)
+#define FORMAT_CACHE DIST_DOUBLE // Distances exactes sans cache ; DIST_FLOAT, DIST_U16 ou DIST_U32 pour un cache approché
+#define TUILE_DISTANCES 64 // Côté des tuiles d'une matrice des distances quantifiée
+#define MAX_FLUX_CAPTAGE 50000 // Nombre de trajets longs au-delà duquel le captage de flux ignore les origines suivantes
+#define PASSES_REPARATION 20 // Nombre maximal de passes de réparation aux frontières des régions (k-médian par régions)
+#define SEUIL_MONOLITHIQUE 400 // Jusqu'à ce nombre de sommets, le k-médian par régions est comparé au k-médian global
+#define MAX_ARRETS_REPARTIS 32 // Nombre maximal d'arrêts de recharge d'un véhicule en simulation répartie
+#define PASSES_CONSOLIDATION 5 // Nombre maximal de passes de recherche locale d'une consolidation du placement en ligne
+#define TRANCHE_EN_LIGNE 1000 // Nombre de demandes par mesure du temps de traitement du placement en ligne
+#define RENDU_GRAPHVIZ 1 // 0 : ne jamais lancer Graphviz après l'export DOT
 
 typedef igraph_t Graph;
 typedef igraph_vector_t Vector;
 typedef enum {
-    EN_MARCHE, ARRIVE, EN_CHARGE, EN_PANNE, AUTRE
+    EN_MARCHE, ARRIVE, EN_CHARGE, EN_ATTENTE, EN_PANNE, AUTRE
 } Statut;
 typedef enum {
     NORMAL, CHARGEUR
@@ -41,22 +71,221 @@ struct Vehicule_s {
     int id;
     int depart, destination, position;
     igraph_vector_int_t chemin; // Itinéraire que va suivre le véhicule
+    int etape; // Indice de la position courante dans chemin
     float batterie;
     Statut statut;
     float distance;
+    float attente; // Temps total passé à attendre une borne (en heures)
 };
 typedef struct Vehicule_s Vehicule;
+typedef struct { // Paramètres de la simulation en flux (système ouvert)
+    char *fichier; // Fichier de trajets "depart,destination[,tour]" ou NULL pour des arrivées aléatoires
+    long nb_trajets; // Arrivées aléatoires : nombre total de trajets
+    double taux; // Arrivées aléatoires : nombre moyen de départs par tour (processus de Poisson)
+    unsigned int graine; // Arrivées aléatoires : graine du générateur
+    int taille_pool; // Nombre maximal de véhicules simultanément sur le réseau
+} ParamFlux;
+typedef struct { // Bilan d'une simulation en flux (ou répartie)
+    long trajets, arrives, pannes, autres, invalides;
+    double distance;
+    long duree_totale, duree_max, attente_totale; // En tours
+} StatistiquesFlux;
+typedef struct { // Paramètres du placement en ligne
+    char *fichier; // Fichier de demandes "sommet[,poids]" (ou de trajets) ou NULL pour des tirages selon la population
+    bool trajets; // Lignes du fichier lues comme des trajets "depart,destination[,tour]" (demande partagée entre les extrémités)
+    long nb_demandes; // Tirages : nombre total de demandes
+    double cout_ouverture; // Coût d'ouverture d'une station, en demande × km
+    int periode; // Consolidation toutes les `periode` demandes (0 : seulement à la fin)
+    unsigned int graine;
+    bool reference; // Compare aussi à la solution hors ligne (coûteuse : une ligne de distances par sommet demandeur)
+} ParamEnLigne;
+typedef struct PlanEnLigne_s PlanEnLigne;
+typedef struct { // Graphe au format CSR (arêtes non orientées dupliquées dans les deux sens)
+    int n;
+    int *debut; // Les voisins de i sont voisins[debut[i]..debut[i+1]-1]
+    int *voisins;
+    double *poids;
+} Csr;
+typedef enum { // Représentation d'une matrice des distances
+    DIST_DOUBLE, // double, une ligne par source (modifiable)
+    DIST_FLOAT, // float, par tuiles
+    DIST_U16, // Entiers 16 bits en unités de echelle km, par tuiles
+    DIST_U32 // Entiers 32 bits en unités de echelle km (le mètre en général), par tuiles
+} FormatDistances;
+typedef struct { // Matrice des plus courtes distances (n×n)
+    int n;
+    double *d; // Une ligne par source (DIST_DOUBLE), NULL sinon
+    FormatDistances format;
+    const void *q; // Valeurs quantifiées par tuiles de TUILE_DISTANCES × TUILE_DISTANCES
+    double echelle; // km par unité (DIST_U16, DIST_U32)
+    void *carte; // Projection en mémoire du fichier cache, NULL sinon
+    size_t taille_carte;
+} Distances;
+typedef struct { // Modification d'une arête du réseau
+    int a, b;
+    double poids; // Nouveau poids (INFINITY pour supprimer l'arête, ajout si elle n'existe pas)
+} ModifArete;
+typedef struct {
+    double cle;
+    int val;
+} ElementTas;
+typedef struct { // Distance routière mesurée entre deux points
+    double lon1, lat1, lon2, lat2;
+    double distance;
+} Troncon;
+typedef struct { // Ensemble de stations candidat
+    char nom[64];
+    int nb;
+    int *sommets;
+} Placement;
+typedef struct { // Évaluation d'un placement
+    double cout; // Coût k-médian : somme des distances au chargeur le plus proche
+    double pire; // Distance maximale d'un sommet à son chargeur le plus proche
+    double couverture; // Pourcentage de la population à moins de RAYON_COUVERTURE d'un chargeur
+} Score;
+typedef struct { // Faisabilité analytique de tous les trajets origine-destination
+    int n;
+    unsigned char *arrets; // n×n : nombre minimal d'arrêts de recharge (ARRETS_IMPOSSIBLE si infaisable), NULL sans détails
+    float *detour; // n×n : longueur du plus court trajet faisable moins la plus courte distance, NULL sans détails
+    double taux_echec; // Part de la demande dont le trajet est infaisable (en %)
+    double arrets_moyens, detour_moyen; // Moyennes pondérées par la demande sur les trajets faisables
+} Faisabilite;
+typedef struct { // Génération de scénarios de perturbation du réseau
+    int nb; // Nombre de scénarios
+    unsigned int graine;
+    double coupures; // Proportion des routes fermées
+    double ralentissements; // Proportion des routes dont la longueur effective est multipliée...
+    double facteur_max; // ... par un facteur tiré uniformément dans [1, facteur_max]
+    double variation_pop; // Population de chaque sommet multipliée par un facteur dans [1 - v, 1 + v]
+} ParamScenarios;
+typedef uint64_t Mot; // Mot d'un ensemble de bits
+typedef enum { // Format d'export du graphe
+    EXPORT_DOT,
+    EXPORT_GEOJSON,
+    EXPORT_SVG
+} FormatExport;
+typedef struct { // Tas binaire minimum
+    ElementTas *elements;
+    int taille, capacite;
+} Tas;
+
+#define MOTS(n) (((n) + 63) / 64) // Nombre de mots pour un ensemble de n bits
+
+static inline void bit_mettre(Mot *b, int i) {
+    b[i >> 6] |= (Mot)1 << (i & 63);
+}
+
+static inline bool bit_tester(const Mot *b, int i) {
+    return (b[i >> 6] >> (i & 63)) & 1;
+}
+
+static inline bool bits_intersectent(const Mot *a, const Mot *b, int mots) {
+    for (int i = 0; i < mots; i++) {
+        if (a[i] & b[i]) return true;
+    }
+    return false;
+}
+
+static inline size_t indice_tuile(const Distances *D, int i, int j) {
+    size_t tuiles = (D->n + TUILE_DISTANCES - 1) / TUILE_DISTANCES;
+    return ((i / TUILE_DISTANCES) * tuiles + j / TUILE_DISTANCES) * TUILE_DISTANCES * TUILE_DISTANCES
+         + (i % TUILE_DISTANCES) * TUILE_DISTANCES + j % TUILE_DISTANCES;
+}
+
+static inline double get_distance(const Distances *D, int i, int j) {
+    switch (D->format) {
+    case DIST_FLOAT:
+        return ((const float *)D->q)[indice_tuile(D, i, j)];
+    case DIST_U16: {
+        uint16_t x = ((const uint16_t *)D->q)[indice_tuile(D, i, j)];
+        return x == UINT16_MAX ? INFINITY : x * D->echelle;
+    }
+    case DIST_U32: {
+        uint32_t x = ((const uint32_t *)D->q)[indice_tuile(D, i, j)];
+        return x == UINT32_MAX ? INFINITY : x * D->echelle;
+    }
+    default:
+        return D->d[(size_t)i * D->n + j];
+    }
+}
 
 // k-médian
+extern bool kmedian_bavard;
 void kmedian(Graph *g, int k, int *centres);
+void kmedian_greedy(Distances *D, int k, int *centres);
+void local_search(Distances *D, int k, int *centres);
+double cost(Distances *D, int *centres, int k);
+void kmedian_maj(Graph *g, Distances *D, ModifArete *modifs, int nb_modifs, int k, int *centres);
+void decouper_regions(Graph *g, int nb_regions, int *region);
+double kmedian_regions(Graph *g, int k, int nb_regions, int *centres);
 double cout_theorique(Graph *g, int *centres);
 double cout_reel(Graph *g, int *centres);
 // Stations
 void definir_station(Graph *graph, Station* stations);
 Station get_station_status(Graph *g, int i);
 void attribuer_stations(Graph *graph);
+// Évaluation de placements
+Placement placement_init(char *nom, int capacite);
+Placement placement_aleatoire(int n, int k, unsigned int *graine, char *nom);
+int tirer_pondere(double *cumul, int n, unsigned int *graine);
+void free_placement(Placement *p);
+void evaluer_placements(Graph *g, Placement *placements, int nb, Score *scores);
+int placements_reference(Graph *g, char *stations_file, int nb_aleatoires, Placement *placements);
+void comparer_placements(Graph *g, char *stations_file, int nb_aleatoires);
+int nb_coeurs(void);
+double secondes(void);
+// Faisabilité des trajets
+bool etape_faisable(double d);
+Faisabilite faisabilite_calculer(Distances *D, double *pop, int *stations, int nb_stations, bool details);
+void analyser_faisabilite(Graph *g);
+void free_faisabilite(Faisabilite *f);
+// Robustesse
+void robustesse_calculer(Graph *g, Placement *placements, int nb, ParamScenarios p, double *base, double *distances);
+void robustesse_placements(Graph *g, Placement *placements, int nb, ParamScenarios p);
+void comparer_robustesse(Graph *g, char *stations_file, int nb_aleatoires, ParamScenarios p);
+// Captage de flux
+double captage_placement(Graph *g, int k, int *stations);
+double captage_evaluer(Graph *g, int *stations, int nb);
+// Placement en ligne
+PlanEnLigne *plan_init(Graph *g, ParamEnLigne param);
+bool plan_demande(PlanEnLigne *p, int v, double w);
+int plan_consolider(PlanEnLigne *p);
+void plan_construire(PlanEnLigne *p);
+double plan_cout(PlanEnLigne *p);
+double plan_hors_ligne(PlanEnLigne *p, int *nb_ajoutees);
+double plan_verifier(PlanEnLigne *p);
+void free_plan(PlanEnLigne *p);
+void placement_en_ligne(Graph *g, ParamEnLigne param);
+// Vérifications
+int verifier(void);
+// Exécution répartie sur plusieurs processus
+void evaluer_placements_repartis(Graph *g, Placement *placements, int nb, Score *scores, int nb_processus);
+StatistiquesFlux simulation_repartie(Graph reseau, ParamFlux param, int nb_processus);
+// Plus courts chemins
+void dijkstra(Csr *c, int *sources, int nb_sources, double *dist, int *pred);
+Distances distances_init(int n);
+Distances distances_calculer(Graph *g);
+uint64_t empreinte_graphe(Graph *g);
+Distances distances_quantifier(Graph *g, FormatDistances format);
+Distances distances_charger(Graph *g, char *prefixe, FormatDistances format);
+void distances_materialiser(Distances *D);
+bool source_affectee(Distances *D, int s, int a, int b, double ancien, double nouveau);
+double tolerance_distances(Distances *D, double d);
+bool arete_affecte(double da, double db, double ancien, double nouveau, double tolerance);
+int distances_maj(Graph *g, Distances *D, ModifArete *modifs, int nb_modifs);
+void free_distances(Distances *D);
+// Tas
+Tas tas_init(int capacite);
+void tas_inserer(Tas *t, double cle, int val);
+ElementTas tas_extraire(Tas *t);
+bool tas_vide(Tas *t);
+void free_tas(Tas *t);
 // Simulation
 void simulation(Graph reseau, int nb_vehicules);
+StatistiquesFlux simulation_flux(Graph reseau, ParamFlux param);
+void afficher_statistiques_flux(StatistiquesFlux *st);
+int comparer_reels(const void *a, const void *b);
+double percentile(double *valeurs, long nb, double q);
 // Graphes
 // - Outils de base
 Graph init(int nb_sommets);
@@ -65,6 +294,7 @@ int vertices_count(Graph *g);
 int edges_count(Graph *g);
 int get_edge_id(Graph *g, int a, int b);
 void add_edge(Graph *g, int a, int b, double weight);
+void remove_edge(Graph *g, int a, int b);
 void get_edge_vertices(Graph *g, int edge_id, int *from, int *to);
 void set_vertix_attribute(Graph *graph, int id, char *attr_name, double value);
 void set_vertix_attributes(Graph *g, char *name, Vector *values);
@@ -75,11 +305,21 @@ void set_edge_attributes(Graph *g, char *name, Vector *values);
 double get_edge_attribute(Graph *g, int id, char *name);
 bool has_edge_attribute(Graph *g, char *name);
 void init_vector(Vector *v, int size);
+double haversine(double lon1, double lat1, double lon2, double lat2);
+Csr csr_from_graph(Graph *g);
+void free_csr(Csr *c);
 // - Autre
 void afficher_graphe(Graph *graph, char *filename);
 Graph get_random_graph(int nb_sommets);
 Graph get_colorado_graph();
+Graph graph_knn(int n, double *lon, double *lat, double *pop, int k, double facteur_detour, Troncon *troncons, int nb_troncons);
 // CSV
 Graph graph_from_csv(char *vertices_file, char *edges_file);
+Placement placement_from_csv(Graph *g, char *stations_file, char *nom);
+Graph graph_knn_from_csv(char *vertices_file, int k, double facteur_detour, char *routes_file);
+void graph_edges_to_csv(Graph *g, char *edges_file);
+// Export
+void exporter_graphe(Graph *g, char *filename, FormatExport format);
+void rendre_graphe(char *dot_file, char *image_file);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,789 @@
+#include "tipe.h"
+
+/*
+ * Vérifications de cohérence (./tipe verifier ou make verifier) : les calculs
+ * incrémentaux, répartis ou accélérés sont comparés à un calcul direct (voire
+ * exhaustif) sur de petits graphes. Chaque vérification affiche OK ou ÉCHEC et
+ * renvoie le nombre d'échecs.
+ */
+
+#define TOLERANCE_VERIFICATION 1e-6
+
+/* Graphe des plus proches voisins sur des points tirés au hasard (reproductible). */
+Graph graphe_verification(int n, unsigned int graine) {
+    double *lon = malloc(n * sizeof(double));
+    double *lat = malloc(n * sizeof(double));
+    double *pop = malloc(n * sizeof(double));
+    for (int i = 0; i < n; i++) {
+        lon[i] = -109.0 + 7.0 * rand_r(&graine) / RAND_MAX;
+        lat[i] = 37.0 + 4.0 * rand_r(&graine) / RAND_MAX;
+        pop[i] = rand_r(&graine) % RAND_POPULATION_MAX;
+    }
+    Graph g = graph_knn(n, lon, lat, pop, 6, FACTEUR_DETOUR, NULL, 0);
+    free(lon);
+    free(lat);
+    free(pop);
+    return g;
+}
+
+/* Plus grand écart entre deux matrices des distances (infini si l'une seulement
+ * est infinie). */
+double ecart_distances(Distances *D, Distances *E) {
+    double ecart = 0.0;
+    for (int i = 0; i < D->n; i++) {
+        for (int j = 0; j < D->n; j++) {
+            double x = get_distance(D, i, j), y = get_distance(E, i, j);
+            if (isinf(x) && isinf(y)) continue;
+            double e = isinf(x) || isinf(y) ? INFINITY : fabs(x - y);
+            if (e > ecart) ecart = e;
+        }
+    }
+    return ecart;
+}
+
+int rapporter(char *nom, bool ok, double ecart) {
+    printf("%-56s %s (écart %.3g)\n", nom, ok ? "OK" : "ÉCHEC", ecart);
+    return ok ? 0 : 1;
+}
+
+/* Crée un fichier temporaire dans le répertoire courant (modele se termine par
+ * XXXXXX et reçoit le nom choisi) ; NULL en cas d'erreur. */
+FILE *fichier_temporaire(char *modele) {
+    int fd = mkstemp(modele);
+    FILE *file = fd == -1 ? NULL : fdopen(fd, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Erreur : impossible de créer le fichier temporaire %s.\n", modele);
+    }
+    return file;
+}
+
+// ---- MISE À JOUR DES DISTANCES ----
+
+/* Compare distances_maj() au recalcul complet après le lot modifs. */
+int verifier_lot(char *nom, Graph *g, Distances *D, ModifArete *modifs, int nb_modifs, double tolerance) {
+    distances_maj(g, D, modifs, nb_modifs);
+    Distances E = distances_calculer(g);
+    double ecart = ecart_distances(D, &E);
+    free_distances(&E);
+    return rapporter(nom, ecart <= tolerance, ecart);
+}
+
+int verifier_distances_maj(void) {
+    int echecs = 0;
+
+    /* Lot mixte : une arête raccourcie dont profitent des sources recalculées
+     * pour une hausse */
+    Graph g = init(5);
+    int aretes[6][2] = { {0, 1}, {1, 2}, {2, 3}, {2, 4}, {0, 4}, {4, 3} };
+    double poids[6] = { 1, 10, 1, 1, 11, 1 };
+    for (int i = 0; i < 6; i++) add_edge(&g, aretes[i][0], aretes[i][1], poids[i]);
+    Distances D = distances_calculer(&g);
+    ModifArete mixte[2] = { {1, 2, 1.0}, {2, 4, 2.0} };
+    echecs += verifier_lot("distances_maj : lot mixte (5 sommets)", &g, &D, mixte, 2, TOLERANCE_VERIFICATION);
+    free_distances(&D);
+    igraph_destroy(&g);
+
+    /* Lots aléatoires de hausses, baisses, suppressions et ajouts */
+    g = graphe_verification(120, 7);
+    D = distances_calculer(&g);
+    unsigned int graine = 11;
+    for (int lot = 0; lot < 5; lot++) {
+        ModifArete modifs[12];
+        for (int i = 0; i < 12; i++) {
+            int a = rand_r(&graine) % 120, b = rand_r(&graine) % 120;
+            if (a == b) b = (b + 1) % 120;
+            int eid = get_edge_id(&g, a, b);
+            double ancien = eid == -1 ? POIDS_MAX : get_edge_attribute(&g, eid, ATTR_WEIGHT);
+            int tirage = rand_r(&graine) % 4;
+            modifs[i].a = a;
+            modifs[i].b = b;
+            modifs[i].poids = tirage == 0 ? INFINITY : tirage == 1 ? ancien * 3.0 : ancien * 0.3;
+        }
+        char nom[64];
+        snprintf(nom, sizeof(nom), "distances_maj : lot aléatoire %d (120 sommets)", lot + 1);
+        echecs += verifier_lot(nom, &g, &D, modifs, 12, TOLERANCE_VERIFICATION);
+    }
+    free_distances(&D);
+    igraph_destroy(&g);
+
+    /* Matrices quantifiées : toutes les arêtes du sommet 0 allongées de 500 km.
+     * Les sources touchées ne sont reconnues qu'à l'arrondi du format près. */
+    FormatDistances formats[2] = { DIST_U16, DIST_FLOAT };
+    char *noms[2] = { "distances_maj : hausses sur matrice U16 (60 sommets)",
+                      "distances_maj : hausses sur matrice float (60 sommets)" };
+    for (int f = 0; f < 2; f++) {
+        g = graphe_verification(60, 13);
+        D = distances_quantifier(&g, formats[f]);
+        double tolerance = formats[f] == DIST_FLOAT ? 1e-3 : D.echelle;
+        Csr c = csr_from_graph(&g);
+        int nb = c.debut[1] - c.debut[0];
+        ModifArete *hausses = malloc(nb * sizeof(ModifArete));
+        for (int e = c.debut[0]; e < c.debut[1]; e++) {
+            hausses[e - c.debut[0]] = (ModifArete){ 0, c.voisins[e], c.poids[e] + 500.0 };
+        }
+        free_csr(&c);
+        echecs += verifier_lot(noms[f], &g, &D, hausses, nb, tolerance);
+        free(hausses);
+        free_distances(&D);
+        igraph_destroy(&g);
+    }
+    return echecs;
+}
+
+// ---- SIMULATION EN FLUX ----
+
+/* Sans station, un trajet arrive (après la plus courte distance) si elle est
+ * dans l'autonomie et échoue sinon : on lit depuis un fichier tous les trajets
+ * d'un petit graphe, plus deux lignes invalides, avec un pool réduit pour
+ * forcer le recyclage des emplacements. */
+int verifier_flux(void) {
+    int n = 60;
+    Graph g = graphe_verification(n, 19);
+    Distances D = distances_calculer(&g);
+
+    char fichier[] = "verification-trajets.XXXXXX";
+    FILE *file = fichier_temporaire(fichier);
+    if (file == NULL) {
+        free_distances(&D);
+        igraph_destroy(&g);
+        return rapporter("simulation_flux : trajets lus depuis un fichier", false, INFINITY);
+    }
+    fprintf(file, "# depart, destination, tour\n%d,%d\nligne invalide\n", 0, n);
+    long trajets = 0, arrives = 0;
+    double distance = 0.0;
+    for (int a = 0; a < n; a++) {
+        for (int b = 0; b < n; b++) {
+            if (a == b) continue;
+            double d = get_distance(&D, a, b);
+            if (fabs(d - AUTONOMIE) < 1e-3 * AUTONOMIE) continue; // Arrondi float de la batterie
+            fprintf(file, "%d,%d,%ld\n", a, b, trajets / 50);
+            trajets++;
+            if (d <= AUTONOMIE) {
+                arrives++;
+                distance += d;
+            }
+        }
+    }
+    fclose(file);
+
+    ParamFlux param = { fichier, 0, 0.0, 0, 16 };
+    StatistiquesFlux st = simulation_flux(g, param);
+    remove(fichier);
+
+    double ecart = st.trajets != trajets || st.arrives != arrives || st.pannes != 0 || st.invalides != 2
+                   ? INFINITY : fabs(st.distance - distance) / fmax(1.0, distance);
+    free_distances(&D);
+    igraph_destroy(&g);
+    return rapporter("simulation_flux : trajets lus depuis un fichier", ecart <= TOLERANCE_VERIFICATION, ecart);
+}
+
+// ---- ÉVALUATION DES PLACEMENTS ----
+
+/* Plus grand écart relatif entre deux scores. */
+double ecart_scores(Score *a, Score *b) {
+    double ecart = 0.0;
+    double x[3][2] = { {a->cout, b->cout}, {a->pire, b->pire}, {a->couverture, b->couverture} };
+    for (int i = 0; i < 3; i++) {
+        if (x[i][0] == x[i][1]) continue;
+        double e = fabs(x[i][0] - x[i][1]) / fmax(1.0, fabs(x[i][0]));
+        if (!(e <= ecart)) ecart = e; // NaN compris
+    }
+    return ecart;
+}
+
+/* Le Dijkstra multi-sources de evaluer_placements() comparé au minimum, pour
+ * chaque sommet, des distances à toutes les stations du placement. */
+int verifier_evaluation(void) {
+    int n = 150;
+    Graph g = graphe_verification(n, 23);
+    Distances D = distances_calculer(&g);
+
+    unsigned int graine = 29;
+    Placement placements[5];
+    for (int i = 0; i < 5; i++) {
+        placements[i] = placement_aleatoire(n, 1 + 6 * i, &graine, "P");
+    }
+    Score scores[5];
+    evaluer_placements(&g, placements, 5, scores);
+
+    double ecart = 0.0;
+    for (int i = 0; i < 5; i++) {
+        Score attendu = { 0.0, 0.0, 0.0 };
+        double pop_totale = 0.0, pop_couverte = 0.0;
+        for (int v = 0; v < n; v++) {
+            double d = INFINITY;
+            for (int j = 0; j < placements[i].nb; j++) {
+                d = fmin(d, get_distance(&D, placements[i].sommets[j], v));
+            }
+            double pop = get_vertix_attribute(&g, v, ATTR_POP);
+            attendu.cout += d;
+            attendu.pire = fmax(attendu.pire, d);
+            pop_totale += pop;
+            if (d <= RAYON_COUVERTURE) pop_couverte += pop;
+        }
+        attendu.couverture = 100.0 * pop_couverte / pop_totale;
+        ecart = fmax(ecart, ecart_scores(&attendu, &scores[i]));
+        ecart = fmax(ecart, fabs(cost(&D, placements[i].sommets, placements[i].nb) - attendu.cout) / attendu.cout);
+        free_placement(&placements[i]);
+    }
+    free_distances(&D);
+    igraph_destroy(&g);
+    return rapporter("evaluer_placements : minimum sur toutes les stations", ecart <= TOLERANCE_VERIFICATION, ecart);
+}
+
+// ---- GRAPHE DES PLUS PROCHES VOISINS ----
+
+/* Écart de poids entre les arêtes de g et celles de h (infini si une arête de
+ * g manque dans h ou si les nombres d'arêtes diffèrent). */
+double ecart_aretes(Graph *g, Graph *h) {
+    if (edges_count(g) != edges_count(h)) return INFINITY;
+    double ecart = 0.0;
+    for (int e = 0; e < edges_count(g); e++) {
+        int a, b;
+        get_edge_vertices(g, e, &a, &b);
+        int f = get_edge_id(h, a, b);
+        if (f == -1) return INFINITY;
+        ecart = fmax(ecart, fabs(get_edge_attribute(g, e, ATTR_WEIGHT) - get_edge_attribute(h, f, ATTR_WEIGHT)));
+    }
+    return ecart;
+}
+
+/* Trois amas éloignés : le graphe doit contenir les k plus proches voisins
+ * trouvés par recherche exhaustive et être connexe, puis se relire à
+ * l'identique en passant par les fichiers CSV des sommets et des arêtes. */
+int verifier_knn(void) {
+    int echecs = 0;
+    int n = 90, k = 3;
+    double lon[90], lat[90], pop[90];
+    unsigned int graine = 31;
+    for (int i = 0; i < n; i++) {
+        lon[i] = -108.0 + 3.0 * (i % 3) + 0.5 * rand_r(&graine) / RAND_MAX;
+        lat[i] = 38.0 + 0.5 * rand_r(&graine) / RAND_MAX;
+        pop[i] = rand_r(&graine) % RAND_POPULATION_MAX;
+    }
+    Graph g = graph_knn(n, lon, lat, pop, k, FACTEUR_DETOUR, NULL, 0);
+
+    int manquantes = 0;
+    for (int i = 0; i < n; i++) {
+        bool pris[90] = { false };
+        pris[i] = true;
+        for (int r = 0; r < k; r++) {
+            int j_min = -1;
+            double d_min = INFINITY;
+            for (int j = 0; j < n; j++) {
+                double d = haversine(lon[i], lat[i], lon[j], lat[j]);
+                if (!pris[j] && d < d_min) {
+                    d_min = d;
+                    j_min = j;
+                }
+            }
+            pris[j_min] = true;
+            if (get_edge_id(&g, i, j_min) == -1) manquantes++;
+        }
+    }
+    Distances D = distances_calculer(&g);
+    int infinies = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (isinf(get_distance(&D, i, j))) infinies++;
+        }
+    }
+    free_distances(&D);
+    echecs += rapporter("graph_knn : voisins exhaustifs présents", manquantes == 0, manquantes);
+    echecs += rapporter("graph_knn : amas reliés en un graphe connexe", infinies == 0, infinies);
+
+    char sommets[] = "verification-sommets.XXXXXX", aretes[] = "verification-aretes.XXXXXX";
+    FILE *file = fichier_temporaire(sommets);
+    if (file == NULL) {
+        igraph_destroy(&g);
+        return echecs + rapporter("graph_knn_from_csv : relecture des CSV", false, INFINITY);
+    }
+    fprintf(file, "# long, lat, population\n");
+    for (int i = 0; i < n; i++) {
+        fprintf(file, "%.17g,%.17g,%.17g\n", lon[i], lat[i], pop[i]);
+    }
+    fclose(file);
+    file = fichier_temporaire(aretes);
+    if (file != NULL) fclose(file);
+
+    Graph h = graph_knn_from_csv(sommets, k, FACTEUR_DETOUR, NULL);
+    double ecart = ecart_aretes(&g, &h);
+    graph_edges_to_csv(&h, aretes);
+    Graph relu = graph_from_csv(sommets, aretes);
+    ecart = fmax(ecart, ecart_aretes(&h, &relu) > 0.005 ? INFINITY : 0.0); // Distances écrites au centième
+    remove(sommets);
+    remove(aretes);
+    echecs += rapporter("graph_knn_from_csv : relecture des CSV", ecart <= TOLERANCE_VERIFICATION, ecart);
+
+    igraph_destroy(&g);
+    igraph_destroy(&h);
+    igraph_destroy(&relu);
+    return echecs;
+}
+
+// ---- FAISABILITÉ DES TRAJETS ----
+
+/* Nombre minimal d'arrêts (parcours en largeur) et longueur du plus court
+ * trajet faisable (Dijkstra en O(S²)) de o à d en passant par les stations. */
+void trajet_exhaustif(Distances *D, int *stations, int nb, int o, int d, int *arrets, double *longueur) {
+    *arrets = ARRETS_IMPOSSIBLE;
+    *longueur = INFINITY;
+    if (o == d || etape_faisable(get_distance(D, o, d))) {
+        *arrets = 0;
+        *longueur = get_distance(D, o, d);
+        return;
+    }
+    int *niveau = malloc(nb * sizeof(int));
+    int *file = malloc(nb * sizeof(int));
+    double *dist = malloc(nb * sizeof(double));
+    bool *fait = calloc(nb, sizeof(bool));
+    int tete = 0, queue = 0;
+    for (int i = 0; i < nb; i++) {
+        bool portee = etape_faisable(get_distance(D, o, stations[i]));
+        niveau[i] = portee ? 1 : -1;
+        dist[i] = portee ? get_distance(D, o, stations[i]) : INFINITY;
+        if (portee) file[queue++] = i;
+    }
+    while (tete < queue) {
+        int i = file[tete++];
+        for (int j = 0; j < nb; j++) {
+            if (niveau[j] == -1 && etape_faisable(get_distance(D, stations[i], stations[j]))) {
+                niveau[j] = niveau[i] + 1;
+                file[queue++] = j;
+            }
+        }
+    }
+    for (int etape = 0; etape < nb; etape++) {
+        int i = -1;
+        for (int j = 0; j < nb; j++) {
+            if (!fait[j] && (i == -1 || dist[j] < dist[i])) i = j;
+        }
+        if (isinf(dist[i])) break;
+        fait[i] = true;
+        for (int j = 0; j < nb; j++) {
+            double e = get_distance(D, stations[i], stations[j]);
+            if (etape_faisable(e) && dist[i] + e < dist[j]) dist[j] = dist[i] + e;
+        }
+    }
+    for (int i = 0; i < nb; i++) {
+        double fin = get_distance(D, stations[i], d);
+        if (niveau[i] == -1 || !etape_faisable(fin)) continue;
+        if (niveau[i] < *arrets) *arrets = niveau[i];
+        if (dist[i] + fin < *longueur) *longueur = dist[i] + fin;
+    }
+    free(niveau);
+    free(file);
+    free(dist);
+    free(fait);
+}
+
+/* Arrêts, détours et taux d'échec de faisabilite_calculer() comparés, trajet
+ * par trajet, à la recherche exhaustive sur le graphe des stations. */
+int verifier_faisabilite(void) {
+    int n = 80;
+    Graph g = graphe_verification(n, 37);
+    Distances D = distances_calculer(&g);
+    unsigned int graine = 41;
+    Placement p = placement_aleatoire(n, 10, &graine, "Stations");
+    double *pop = malloc(n * sizeof(double));
+    for (int v = 0; v < n; v++) {
+        pop[v] = get_vertix_attribute(&g, v, ATTR_POP);
+    }
+    Faisabilite f = faisabilite_calculer(&D, pop, p.sommets, p.nb, true);
+
+    int differences = 0;
+    double ecart = 0.0, demande = 0.0, echec = 0.0;
+    for (int o = 0; o < n; o++) {
+        for (int d = 0; d < n; d++) {
+            int arrets;
+            double longueur;
+            trajet_exhaustif(&D, p.sommets, p.nb, o, d, &arrets, &longueur);
+            size_t od = (size_t)o * n + d;
+            if (f.arrets[od] != arrets) differences++;
+            if (arrets != ARRETS_IMPOSSIBLE) {
+                double detour = longueur - get_distance(&D, o, d);
+                ecart = fmax(ecart, fabs(f.detour[od] - detour) / fmax(1.0, detour));
+            }
+            if (o == d) continue;
+            demande += pop[o];
+            if (arrets == ARRETS_IMPOSSIBLE) echec += pop[o];
+        }
+    }
+    ecart = fmax(ecart, fabs(f.taux_echec - 100.0 * echec / demande) / 100.0);
+
+    int echecs = rapporter("faisabilite_calculer : arrêts minimaux exhaustifs", differences == 0, differences);
+    echecs += rapporter("faisabilite_calculer : détours et taux d'échec", ecart <= 1e-5, ecart); // Détours en float
+    free_faisabilite(&f);
+    free(pop);
+    free_placement(&p);
+    free_distances(&D);
+    igraph_destroy(&g);
+    return echecs;
+}
+
+// ---- EXPORT DU GRAPHE ----
+
+/* Compte les nœuds (et la somme des sommets qu'ils regroupent) et les arêtes
+ * d'un export DOT ou GeoJSON relu ligne par ligne. */
+void compter_export(char *fichier, int *noeuds, int *sommets, int *aretes) {
+    *noeuds = *sommets = *aretes = 0;
+    FILE *file = fopen(fichier, "r");
+    if (file == NULL) return;
+    char line[MAX_LINE_LENGTH];
+    while (fgets(line, MAX_LINE_LENGTH, file)) {
+        char *regroupes = strstr(line, "\"sommets\":");
+        int id;
+        if (strstr(line, " -- ") != NULL || strstr(line, "\"LineString\"") != NULL) {
+            (*aretes)++;
+        } else if (regroupes != NULL) {
+            (*noeuds)++;
+            *sommets += atoi(regroupes + strlen("\"sommets\":"));
+        } else if (sscanf(line, " %d [", &id) == 1) {
+            (*noeuds)++;
+            (*sommets)++;
+        }
+    }
+    fclose(file);
+}
+
+/* Un export complet (DOT) contient chaque sommet et chaque arête ; un export
+ * simplifié (GeoJSON au-delà de SEUIL_LOD sommets, graphe des 2 plus proches
+ * voisins pour que la plupart des degrés soient sous DEGRE_LOD) a moins de
+ * nœuds, mais ses groupes couvrent exactement les sommets du graphe. */
+int verifier_export(void) {
+    int echecs = 0;
+    int tailles[2] = { 200, 2 * SEUIL_LOD };
+    FormatExport formats[2] = { EXPORT_DOT, EXPORT_GEOJSON };
+    char *noms[2] = { "exporter_graphe : DOT complet", "exporter_graphe : GeoJSON simplifié" };
+    for (int i = 0; i < 2; i++) {
+        double *lon = malloc(tailles[i] * sizeof(double));
+        double *lat = malloc(tailles[i] * sizeof(double));
+        unsigned int graine = 43;
+        for (int v = 0; v < tailles[i]; v++) {
+            lon[v] = -109.0 + 7.0 * rand_r(&graine) / RAND_MAX;
+            lat[v] = 37.0 + 4.0 * rand_r(&graine) / RAND_MAX;
+        }
+        Graph g = graph_knn(tailles[i], lon, lat, NULL, 2, FACTEUR_DETOUR, NULL, 0);
+        free(lon);
+        free(lat);
+        char fichier[] = "verification-export.XXXXXX";
+        FILE *file = fichier_temporaire(fichier);
+        if (file == NULL) {
+            igraph_destroy(&g);
+            echecs += rapporter(noms[i], false, INFINITY);
+            continue;
+        }
+        fclose(file);
+        exporter_graphe(&g, fichier, formats[i]);
+        int noeuds, sommets, aretes;
+        compter_export(fichier, &noeuds, &sommets, &aretes);
+        remove(fichier);
+
+        int n = vertices_count(&g), m = edges_count(&g);
+        bool ok = i == 0 ? noeuds == n && aretes == m
+                         : sommets == n && noeuds < n && aretes > 0 && aretes < m;
+        echecs += rapporter(noms[i], ok, abs(sommets - n));
+        igraph_destroy(&g);
+    }
+    return echecs;
+}
+
+// ---- K-MÉDIAN PAR RÉGIONS ----
+
+/* Sous SEUIL_MONOLITHIQUE sommets, le coût renvoyé par kmedian_regions() doit
+ * être celui de ses centres sur la matrice globale ; en une seule région il
+ * ne peut pas dépasser celui du k-médian global (même glouton et même
+ * recherche locale, suivis de la réparation), et en plusieurs régions il doit
+ * en rester proche. */
+int verifier_regions(void) {
+    int echecs = 0;
+    int n = 300, k = 12;
+    Graph g = graphe_verification(n, 47);
+    Distances D = distances_calculer(&g);
+    bool bavard = kmedian_bavard;
+    kmedian_bavard = false;
+    int global[12];
+    kmedian_greedy(&D, k, global);
+    local_search(&D, k, global);
+    double cout_global = cost(&D, global, k);
+
+    int nb_regions[2] = { 1, 4 };
+    for (int i = 0; i < 2; i++) {
+        int centres[12];
+        double cout_renvoye = kmedian_regions(&g, k, nb_regions[i], centres);
+        double cout_centres = cost(&D, centres, k);
+        double ecart = fabs(cout_renvoye - cout_centres) / cout_centres;
+        double penalite = (cout_centres - cout_global) / cout_global;
+        char nom[64];
+        snprintf(nom, sizeof(nom), "kmedian_regions : coût renvoyé (%d région(s))", nb_regions[i]);
+        echecs += rapporter(nom, ecart <= TOLERANCE_VERIFICATION, ecart);
+        snprintf(nom, sizeof(nom), "kmedian_regions : pénalité / k-médian (%d région(s))", nb_regions[i]);
+        echecs += rapporter(nom, penalite <= (nb_regions[i] == 1 ? TOLERANCE_VERIFICATION : 0.1), penalite);
+    }
+    kmedian_bavard = bavard;
+    free_distances(&D);
+    igraph_destroy(&g);
+    return echecs;
+}
+
+// ---- CAPTAGE DE FLUX ----
+
+/* Part du flux des trajets longs captée, en parcourant chaque plus court
+ * chemin sommet par sommet et en rechargeant à chaque station traversée. */
+double captage_exhaustif(Graph *g, int *stations, int nb) {
+    Csr c = csr_from_graph(g);
+    int n = c.n;
+    bool *est_station = calloc(n, sizeof(bool));
+    for (int i = 0; i < nb; i++) est_station[stations[i]] = true;
+    double *dist = malloc(n * sizeof(double));
+    int *pred = malloc(n * sizeof(int));
+    int *chemin = malloc(n * sizeof(int));
+    double total = 0.0, capte = 0.0;
+    for (int o = 0; o < n; o++) {
+        double flux = get_vertix_attribute(g, o, ATTR_POP) / (n - 1);
+        if (flux <= 0.0) continue;
+        dijkstra(&c, &o, 1, dist, pred);
+        for (int d = 0; d < n; d++) {
+            if (d == o || isinf(dist[d]) || dist[d] <= AUTONOMIE) continue;
+            total += flux;
+            int h = 0;
+            for (int v = d; v != -1; v = pred[v]) chemin[h++] = v;
+            double recharge = 0.0; // Position de la dernière recharge
+            bool faisable = true;
+            for (int j = h - 1; j >= 0 && faisable; j--) {
+                if (dist[chemin[j]] > recharge + AUTONOMIE) faisable = false;
+                if (est_station[chemin[j]]) recharge = dist[chemin[j]];
+            }
+            if (faisable) capte += flux;
+        }
+    }
+    free(est_station);
+    free(dist);
+    free(pred);
+    free(chemin);
+    free_csr(&c);
+    return total > 0.0 ? 100.0 * capte / total : 0.0;
+}
+
+/* Les fenêtres de captage_evaluer() comparées au parcours des chemins, pour
+ * un placement aléatoire et pour celui de captage_placement(). */
+int verifier_captage(void) {
+    int n = 60;
+    Graph g = graphe_verification(n, 53);
+    unsigned int graine = 59;
+    Placement p = placement_aleatoire(n, 8, &graine, "Aléatoire");
+    double attendu = captage_exhaustif(&g, p.sommets, p.nb);
+    double ecart = fabs(captage_evaluer(&g, p.sommets, p.nb) - attendu);
+    int echecs = rapporter("captage_evaluer : parcours des plus courts chemins", ecart <= TOLERANCE_VERIFICATION && attendu > 0.0, ecart);
+
+    int stations[6];
+    double part = captage_placement(&g, 6, stations);
+    attendu = captage_exhaustif(&g, stations, 6);
+    ecart = fabs(part - attendu);
+    echecs += rapporter("captage_placement : part captée par ses stations", ecart <= TOLERANCE_VERIFICATION && attendu > 0.0, ecart);
+
+    free_placement(&p);
+    igraph_destroy(&g);
+    return echecs;
+}
+
+// ---- ROBUSTESSE ----
+
+/* Distance moyenne par habitant de chaque placement dans le scénario s, tiré
+ * comme evaluer_scenario() (même graine, mêmes arêtes dans le même ordre) et
+ * recalculé par un Dijkstra multi-sources complet. */
+void scenario_direct(Graph *g, Placement *placements, int nb, ParamScenarios p, int s, double *distances) {
+    Csr c = csr_from_graph(g);
+    int n = c.n;
+    unsigned int graine = p.graine + 7919u * (unsigned int)s;
+    for (int u = 0; u < n; u++) {
+        for (int i = c.debut[u]; i < c.debut[u+1]; i++) {
+            int v = c.voisins[i];
+            if (u >= v) continue;
+            double r = (double)rand_r(&graine) / RAND_MAX;
+            double nouveau;
+            if (r < p.coupures) {
+                nouveau = INFINITY;
+            } else if (r < p.coupures + p.ralentissements) {
+                nouveau = c.poids[i] * (1.0 + (p.facteur_max - 1.0) * rand_r(&graine) / RAND_MAX);
+            } else {
+                continue;
+            }
+            for (int j = c.debut[v]; j < c.debut[v+1]; j++) {
+                if (c.voisins[j] == u) c.poids[j] = nouveau;
+            }
+            c.poids[i] = nouveau;
+        }
+    }
+    double *pop = malloc(n * sizeof(double));
+    for (int v = 0; v < n; v++) {
+        pop[v] = get_vertix_attribute(g, v, ATTR_POP) * (1.0 - p.variation_pop + 2.0 * p.variation_pop * rand_r(&graine) / RAND_MAX);
+    }
+    double *dist = malloc(n * sizeof(double));
+    for (int k = 0; k < nb; k++) {
+        dijkstra(&c, placements[k].sommets, placements[k].nb, dist, NULL);
+        double total = 0.0, habitants = 0.0;
+        for (int v = 0; v < n; v++) {
+            if (pop[v] > 0.0) total += pop[v] * dist[v];
+            habitants += pop[v];
+        }
+        distances[k] = total / habitants;
+    }
+    free(pop);
+    free(dist);
+    free_csr(&c);
+}
+
+/* Les réparations limitées aux sous-arbres invalidés (coupures et
+ * ralentissements) et le recalcul des lignes touchées par un raccourci
+ * (facteur_max < 1) comparés au recalcul complet de chaque scénario. */
+int verifier_robustesse(void) {
+    int echecs = 0;
+    int n = 150;
+    Graph g = graphe_verification(n, 61);
+    unsigned int graine = 67;
+    Placement placements[3];
+    for (int k = 0; k < 3; k++) {
+        placements[k] = placement_aleatoire(n, 2 + 5 * k, &graine, "P");
+    }
+    ParamScenarios params[2] = { { 16, 3, 0.01, 0.03, 3.0, 0.2 }, { 16, 5, 0.0, 0.3, 0.5, 0.0 } };
+    char *noms[2] = { "robustesse : coupures et ralentissements", "robustesse : routes raccourcies" };
+    for (int i = 0; i < 2; i++) {
+        ParamScenarios p = params[i];
+        double base[3], distances[3 * 16], directes[3];
+        robustesse_calculer(&g, placements, 3, p, base, distances);
+        double ecart = 0.0;
+        for (int s = 0; s < p.nb; s++) {
+            scenario_direct(&g, placements, 3, p, s, directes);
+            for (int k = 0; k < 3; k++) {
+                double x = distances[k * p.nb + s], y = directes[k];
+                if (isinf(x) && isinf(y)) continue;
+                ecart = fmax(ecart, isinf(x) || isinf(y) ? INFINITY : fabs(x - y) / fmax(1.0, y));
+            }
+        }
+        echecs += rapporter(noms[i], ecart <= TOLERANCE_VERIFICATION, ecart);
+    }
+    for (int k = 0; k < 3; k++) free_placement(&placements[k]);
+    igraph_destroy(&g);
+    return echecs;
+}
+
+// ---- EXÉCUTION RÉPARTIE ----
+
+/* Écart entre deux bilans de simulation : infini si les nombres de trajets ne
+ * correspondent pas, sinon le plus grand écart relatif sur la distance totale
+ * et sur la durée moyenne. */
+double ecart_bilans(StatistiquesFlux *a, StatistiquesFlux *b) {
+    if (a->trajets != b->trajets || a->arrives != b->arrives || a->pannes != b->pannes || a->autres != b->autres
+        || a->trajets == 0) {
+        return INFINITY;
+    }
+    double distance = fabs(a->distance - b->distance) / fmax(1.0, a->distance);
+    double duree = fabs((double)(a->duree_totale - b->duree_totale)) / fmax(1.0, (double)a->duree_totale);
+    return fmax(distance, duree);
+}
+
+/* Évaluation et simulation réparties comparées aux versions en un seul
+ * processus (l'attente d'un emplacement dépend du rythme du pipeline en flux
+ * et n'est comparée qu'entre exécutions réparties). */
+int verifier_reparti(void) {
+    int echecs = 0;
+    int n = 200;
+    Graph g = graphe_verification(n, 17);
+
+    unsigned int graine = 5;
+    Placement placements[4];
+    for (int i = 0; i < 4; i++) {
+        char nom[16];
+        snprintf(nom, sizeof(nom), "P%d", i);
+        placements[i] = placement_aleatoire(n, 3 + 8 * i, &graine, nom);
+    }
+    Score attendus[4], obtenus[4];
+    evaluer_placements(&g, placements, 4, attendus);
+    int processus[2] = { 1, 3 };
+    for (int k = 0; k < 2; k++) {
+        evaluer_placements_repartis(&g, placements, 4, obtenus, processus[k]);
+        double ecart = 0.0;
+        for (int i = 0; i < 4; i++) ecart = fmax(ecart, ecart_scores(&attendus[i], &obtenus[i]));
+        char nom[64];
+        snprintf(nom, sizeof(nom), "evaluer_placements_repartis : %d processus", processus[k]);
+        echecs += rapporter(nom, ecart <= TOLERANCE_VERIFICATION, ecart);
+    }
+
+    for (int i = 0; i < placements[2].nb; i++) {
+        set_vertix_attribute(&g, placements[2].sommets[i], ATTR_STATION, CHARGEUR);
+    }
+    ParamFlux param = { NULL, 1500, 2.0, 7, 200 };
+    StatistiquesFlux un = simulation_repartie(g, param, 1);
+    StatistiquesFlux quatre = simulation_repartie(g, param, 4);
+    StatistiquesFlux flux = simulation_flux(g, param);
+    double ecart = ecart_bilans(&un, &quatre);
+    bool identiques = ecart <= TOLERANCE_VERIFICATION && un.duree_max == quatre.duree_max
+                      && un.attente_totale == quatre.attente_totale;
+    echecs += rapporter("simulation_repartie : 1 et 4 processus", identiques, ecart);
+    ecart = ecart_bilans(&quatre, &flux);
+    echecs += rapporter("simulation_repartie : 4 processus et simulation_flux",
+                        ecart <= TOLERANCE_VERIFICATION && quatre.duree_max == flux.duree_max, ecart);
+
+    for (int i = 0; i < 4; i++) free_placement(&placements[i]);
+    igraph_destroy(&g);
+    return echecs;
+}
+
+// ---- PLACEMENT EN LIGNE ----
+
+/* Distances tenues à jour par les ouvertures en ligne et variations de coût de
+ * la consolidation, avant et après une consolidation. */
+int verifier_en_ligne(void) {
+    int n = 150;
+    Graph g = graphe_verification(n, 71);
+    set_vertix_attribute(&g, 10, ATTR_STATION, CHARGEUR);
+    set_vertix_attribute(&g, 90, ATTR_STATION, CHARGEUR);
+    double *pop_cumulee = malloc(n * sizeof(double));
+    double cumul = 0.0;
+    for (int v = 0; v < n; v++) {
+        cumul += get_vertix_attribute(&g, v, ATTR_POP);
+        pop_cumulee[v] = cumul;
+    }
+
+    ParamEnLigne param = { NULL, false, 2000, 3000.0, 0, 73, false };
+    PlanEnLigne *p = plan_init(&g, param);
+    unsigned int graine = 79;
+    double ecart = 0.0;
+    for (int i = 1; i <= param.nb_demandes; i++) {
+        plan_demande(p, tirer_pondere(pop_cumulee, n, &graine), 1.0 + rand_r(&graine) % 3);
+        if (i == param.nb_demandes / 2) {
+            ecart = fmax(ecart, plan_verifier(p));
+            plan_consolider(p);
+        }
+    }
+    ecart = fmax(ecart, plan_verifier(p));
+    int echecs = rapporter("plan_variation : recalcul complet du coût", ecart <= TOLERANCE_VERIFICATION, ecart);
+
+    free_plan(p);
+    free(pop_cumulee);
+    igraph_destroy(&g);
+    return echecs;
+}
+
+// ---- VÉRIFICATION ----
+
+/* Lance toutes les vérifications ; renvoie le nombre d'échecs. */
+int verifier(void) {
+    printf("\nVÉRIFICATIONS\n\n");
+    igraph_set_attribute_table(&igraph_cattribute_table);
+    int echecs = 0;
+    echecs += verifier_distances_maj();
+    echecs += verifier_flux();
+    echecs += verifier_evaluation();
+    echecs += verifier_knn();
+    echecs += verifier_faisabilite();
+    echecs += verifier_export();
+    echecs += verifier_regions();
+    echecs += verifier_captage();
+    echecs += verifier_robustesse();
+    echecs += verifier_reparti();
+    echecs += verifier_en_ligne();
+    printf("\n%d échec(s)\n", echecs);
+    return echecs;
+}